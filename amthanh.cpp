@@ -0,0 +1,93 @@
+#include "amthanh.h"
+#include <algorithm>
+#include <cmath>
+
+void initSoundMixer(SoundMixer& mixer) {
+    Mix_AllocateChannels(MAX_VOICES);
+    for (Voice& voice : mixer.voices)
+        voice = {-1, 0, 0};
+}
+
+int addSound(SoundMixer& mixer, Mix_Chunk* chunk, int priority, int maxVoices, int volume) {
+    mixer.sounds.push_back({chunk, priority, std::max(maxVoices, 1), volume, 0});
+    mixer.order.reserve(mixer.sounds.size());
+    return mixer.sounds.size() - 1;
+}
+
+// Âm lượng cho count sự kiện gộp lại: mỗi lần gấp đôi số sự kiện thì to thêm nửa mức
+// một sự kiện (như nhiều tiếng nổ cùng lúc nghe to hơn nhưng không cộng thẳng), tối đa MIX_MAX_VOLUME
+static int mergedVolume(int volume, int count) {
+    double gain = 1.0 + 0.5 * std::log2((double)count);
+    return std::min((int)(volume * gain + 0.5), MIX_MAX_VOLUME);
+}
+
+// Kênh để phát âm sound, -1 nếu không có. Âm đã chiếm đủ maxVoices kênh thì lấy lại kênh
+// cũ nhất của chính nó; còn kênh trống thì lấy kênh trống; không thì cướp kênh có ưu tiên
+// thấp nhất (không cao hơn âm mới), cùng ưu tiên thì kênh phát lâu nhất.
+static int pickVoice(const SoundMixer& mixer, int sound) {
+    const SoundInfo& info = mixer.sounds[sound];
+    int own = 0, oldestOwn = -1, freeVoice = -1, victim = -1;
+    for (int ch = 0; ch < MAX_VOICES; ch++) {
+        const Voice& voice = mixer.voices[ch];
+        if (voice.sound == -1) {
+            if (freeVoice < 0) freeVoice = ch;
+            continue;
+        }
+        if (voice.sound == sound) {
+            own++;
+            if (oldestOwn < 0 || voice.started < mixer.voices[oldestOwn].started) oldestOwn = ch;
+        }
+        if (voice.priority > info.priority) continue;
+        if (victim < 0 || voice.priority < mixer.voices[victim].priority ||
+            (voice.priority == mixer.voices[victim].priority && voice.started < mixer.voices[victim].started))
+            victim = ch;
+    }
+    if (own >= info.maxVoices) return oldestOwn;
+    if (freeVoice >= 0) return freeVoice;
+    return victim;
+}
+
+void flushSounds(SoundMixer& mixer) {
+    // Kênh phát xong thì trống lại
+    for (int ch = 0; ch < MAX_VOICES; ch++) {
+        if (mixer.voices[ch].sound != -1 && !Mix_Playing(ch)) mixer.voices[ch].sound = -1;
+    }
+
+    // Âm ưu tiên cao chọn kênh trước. Chèn vào sau các âm cùng ưu tiên nên giữ thứ tự đăng ký
+    // như stable_sort, nhưng không cần bộ nhớ tạm; addSound đã dành đủ chỗ cho order
+    std::vector<int>& order = mixer.order;
+    order.clear();
+    for (int i = 0; i < (int)mixer.sounds.size(); i++) {
+        if (mixer.sounds[i].pending == 0) continue;
+        int priority = mixer.sounds[i].priority;
+        auto at = std::upper_bound(order.begin(), order.end(), priority,
+                                   [&](int p, int sound) { return p > mixer.sounds[sound].priority; });
+        order.insert(at, i);
+    }
+
+    for (int sound : order) {
+        SoundInfo& info = mixer.sounds[sound];
+        int count = info.pending;
+        info.pending = 0;
+        if (!info.chunk) continue;
+
+        int ch = pickVoice(mixer, sound);
+        if (ch < 0) {
+            mixer.dropped++;
+            continue;
+        }
+        if (mixer.voices[ch].sound != -1) {
+            Mix_HaltChannel(ch);
+            mixer.stolen++;
+        }
+        Mix_Volume(ch, mergedVolume(info.volume, count));
+        if (Mix_PlayChannel(ch, info.chunk, 0) == -1) {
+            mixer.voices[ch].sound = -1;
+            mixer.dropped++;
+            continue;
+        }
+        mixer.voices[ch] = {sound, info.priority, mixer.tick};
+        mixer.played++;
+    }
+    mixer.tick++;
+}
@@ -0,0 +1,57 @@
+#pragma once
+// Phát âm thanh theo sự kiện. Code game chỉ gọi postSound (không gọi Mix_PlayChannel);
+// mỗi tick flushSounds gộp mọi sự kiện cùng một âm trong tick thành một lần phát, to
+// hơn theo số sự kiện, rồi chia kênh theo giới hạn: mỗi âm tối đa maxVoices kênh, cả
+// game tối đa MAX_VOICES kênh. Hết kênh thì âm ưu tiên cao cướp kênh của âm ưu tiên thấp
+// hơn (hoặc bằng) đang phát lâu nhất; không cướp được thì sự kiện bị bỏ.
+// Vì vậy mỗi tick có tối đa một lần phát cho mỗi âm và bộ trộn không bao giờ trộn quá
+// MAX_VOICES kênh, dù bao nhiêu xe bắn cùng lúc.
+#include <SDL_mixer.h>
+#include <vector>
+
+const int MAX_VOICES = 16;
+
+struct SoundInfo {
+    Mix_Chunk* chunk;
+    int priority;   // Cao hơn thì được cướp kênh của âm thấp hơn khi hết kênh
+    int maxVoices;  // Số kênh tối đa âm này chiếm cùng lúc; đủ rồi thì thay kênh cũ nhất của chính nó
+    int volume;     // Âm lượng của một sự kiện (0..MIX_MAX_VOLUME)
+    int pending;    // Số sự kiện trong tick hiện tại, chưa phát
+};
+
+// Kênh đang phát gì; sound = -1 là kênh trống
+struct Voice {
+    int sound;
+    int priority;
+    unsigned int started; // Tick bắt đầu phát, để tìm kênh phát lâu nhất
+};
+
+struct SoundMixer {
+    std::vector<SoundInfo> sounds;
+    Voice voices[MAX_VOICES];
+    unsigned int tick = 0;
+    std::vector<int> order; // Âm có sự kiện trong tick, ưu tiên cao trước; dùng lại mỗi tick để không cấp phát
+
+    // Thống kê cả trận
+    long long events = 0;  // Số lần postSound
+    long long played = 0;  // Số lần thật sự gọi Mix_PlayChannel
+    long long stolen = 0;  // Số lần phải dừng một kênh đang phát để lấy chỗ
+    long long dropped = 0; // Số lần phát bị bỏ vì không còn kênh
+};
+
+// Dành MAX_VOICES kênh của SDL_mixer cho mixer (gọi sau Mix_OpenAudio)
+void initSoundMixer(SoundMixer& mixer);
+
+// Đăng ký một âm, trả về số hiệu để gọi postSound; chunk nullptr thì postSound bỏ qua
+int addSound(SoundMixer& mixer, Mix_Chunk* chunk, int priority, int maxVoices, int volume);
+
+// Ghi nhận một sự kiện âm thanh trong tick hiện tại; chỉ tăng một bộ đếm
+inline void postSound(SoundMixer& mixer, int sound) {
+    if (sound >= 0 && sound < (int)mixer.sounds.size()) {
+        mixer.sounds[sound].pending++;
+        mixer.events++;
+    }
+}
+
+// Phát các sự kiện đã gộp của tick và sang tick mới; gọi một lần mỗi tick
+void flushSounds(SoundMixer& mixer);
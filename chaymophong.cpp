@@ -0,0 +1,110 @@
+// Chạy mô phỏng không cần cửa sổ, nhanh nhất có thể, rồi in số tick/giây.
+// Biên dịch: g++ -O2 chaymophong.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp phatlai.cpp -o chaymophong
+// Cách dùng: chaymophong [soTick] [seed] [msMoiTick]
+//            chaymophong --record file.rep [seed]   (ghi lại một trận của bot)
+//            chaymophong --replay file.rep [soLan]  (phát lại và kiểm tra trạng thái cuối)
+// msMoiTick lớn hơn 16 thì mỗi tick mô phỏng dài hơn (ít tick hơn cho mỗi trận); nhận 1..MAX_TICK_MS.
+#include "mophong.h"
+#include "phatlai.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+// Ghi lại một trận của bot trên bản đồ mặc định
+int recordMatch(const char* path, unsigned int seed) {
+    Replay replay;
+    startReplay(replay, seed, TICK_MS);
+    World world;
+    initWorld(world, seed);
+    Rng botRng;
+    seedRng(botRng, ~(unsigned long long)seed);
+    while (!isGameOver(world)) {
+        Input input = botInput(world, botRng);
+        if (input.move != MOVE_NONE || input.shootSmall || input.shootLarge)
+            recordInput(replay, world.tick, input);
+        step(world, input);
+    }
+    finishReplay(replay, world);
+    if (!saveReplay(replay, path)) {
+        std::cout << "Không ghi được file " << path << std::endl;
+        return 1;
+    }
+    std::cout << "Đã ghi " << replay.events.size() << " phím, " << replay.finalTick
+              << " tick vào " << path << std::endl;
+    return 0;
+}
+
+// Phát lại trận đã ghi repeat lần, đo tốc độ và so mã băm trạng thái cuối
+int replayMatch(const char* path, int repeat) {
+    Replay replay;
+    if (!loadReplay(replay, path)) {
+        std::cout << "Không đọc được file replay " << path << std::endl;
+        return 1;
+    }
+    World world;
+    bool same = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++)
+        same = playReplay(replay, world) && same;
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double ticks = (double)replay.finalTick * repeat;
+    std::cout << "seed: " << replay.seed << ", " << replay.events.size() << " phím, "
+              << replay.finalTick << " tick" << std::endl;
+    std::cout << "phát lại " << repeat << " lần: " << seconds << " s ("
+              << (seconds > 0 ? ticks / seconds : 0) << " tick/giây)" << std::endl;
+    std::cout << (same ? "trạng thái cuối khớp" : "TRẠNG THÁI CUỐI KHÔNG KHỚP") << std::endl;
+    return same ? 0 : 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+        unsigned int seed = argc > 3 ? (unsigned int)atoll(argv[3]) : (unsigned int)time(nullptr);
+        return recordMatch(argv[2], seed);
+    }
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+        return replayMatch(argv[2], argc > 3 ? atoi(argv[3]) : 1);
+
+    long long tickCount = argc > 1 ? atoll(argv[1]) : 1000000;
+    unsigned int seed = argc > 2 ? (unsigned int)atoll(argv[2]) : (unsigned int)time(nullptr);
+    int tickMs = argc > 3 ? atoi(argv[3]) : TICK_MS;
+    if (tickMs < 1 || tickMs > MAX_TICK_MS) {
+        std::cout << "msMoiTick phải trong khoảng 1.." << MAX_TICK_MS << std::endl;
+        return 1;
+    }
+
+    World world;
+    initWorld(world, seed);
+    world.tickMs = tickMs;
+    // Seed của bot đảo bit nên không trùng seed 32 bit của trận nào
+    Rng botRng;
+    seedRng(botRng, ~(unsigned long long)seed);
+    long long matches = 0;
+    long long dropped = 0; // Đạn bị bỏ vì kho đầy, cộng qua mọi trận
+
+    auto start = std::chrono::steady_clock::now();
+    for (long long t = 0; t < tickCount; t++) {
+        step(world, botInput(world, botRng));
+        // Hết trận thì bắt đầu trận mới (seed + số trận) để luôn chạy đủ số tick
+        if (isGameOver(world)) {
+            matches++;
+            dropped += world.droppedBullets;
+            initWorld(world, seed + matches);
+            world.tickMs = tickMs;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    dropped += world.droppedBullets;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "seed: " << seed << std::endl;
+    std::cout << "tick: " << tickCount << " (" << tickMs << " ms/tick)" << std::endl;
+    std::cout << "số trận kết thúc: " << matches << std::endl;
+    std::cout << "đạn bị bỏ (kho đầy): " << dropped << std::endl;
+    std::cout << "thời gian: " << seconds << " s" << std::endl;
+    std::cout << "tick/giây: " << (seconds > 0 ? tickCount / seconds : 0) << std::endl;
+    return 0;
+}
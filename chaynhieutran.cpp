@@ -0,0 +1,118 @@
+// Chạy hàng nghìn trận độc lập song song (người chơi tự động đấu với AI xe địch
+// của ngay4) để cân bằng game, rồi ghi kết quả từng trận ra file CSV.
+// Mỗi luồng có World riêng nên các trận không dùng chung trạng thái nào.
+// Biên dịch: g++ -O2 -pthread chaynhieutran.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp -o chaynhieutran
+// Cách dùng: chaynhieutran [soTran] [soLuong] [fileKetQua]
+//            chaynhieutran --scaling [soTran]   (in số trận/giây với 1..N luồng)
+#include "mophong.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+const int MAX_MATCH_TICKS = 60 * 1000 / TICK_MS; // Trận dài quá 60 giây tính là hòa
+
+// Kết quả một trận
+struct MatchResult {
+    int winner;         // 0: hòa, 1: người chơi, 2: xe địch
+    unsigned int ticks;
+    int enemiesLeft;
+    int obstaclesLeft;
+};
+
+MatchResult playMatch(World& world, int match) {
+    // Trận thứ match luôn dùng seed match nên kết quả không phụ thuộc số luồng
+    initWorld(world, match);
+    Rng botRng;
+    seedRng(botRng, ~(unsigned long long)match);
+    while (!isGameOver(world) && world.tick < (unsigned int)MAX_MATCH_TICKS)
+        step(world, botInput(world, botRng));
+
+    MatchResult result;
+    result.winner = !world.playerAlive ? 2 : (isGameOver(world) ? 1 : 0);
+    result.ticks = world.tick;
+    result.enemiesLeft = world.enemies.count;
+    result.obstaclesLeft = countCells(world.obstacleBits);
+    return result;
+}
+
+// Chạy matchCount trận trên threadCount luồng; mỗi luồng lấy trận kế tiếp
+// từ một bộ đếm chung. Trả về thời gian chạy (giây).
+double runBatch(int matchCount, int threadCount, std::vector<MatchResult>& results) {
+    results.assign(matchCount, MatchResult());
+    std::atomic<int> nextMatch(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([&]() {
+            World world; // Dùng lại cho mọi trận của luồng này, không cấp phát lại kho đạn
+            for (int m = nextMatch++; m < matchCount; m = nextMatch++)
+                results[m] = playMatch(world, m);
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+bool writeResults(const char* path, const std::vector<MatchResult>& results) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "tran,ben_thang,tick,xe_dich_con,chuong_ngai_con\n");
+    for (int m = 0; m < (int)results.size(); m++) {
+        const MatchResult& r = results[m];
+        fprintf(file, "%d,%d,%u,%d,%d\n", m, r.winner, r.ticks, r.enemiesLeft, r.obstaclesLeft);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+    std::vector<MatchResult> results;
+
+    if (argc > 1 && strcmp(argv[1], "--scaling") == 0) {
+        int matchCount = argc > 2 ? atoi(argv[2]) : 2000;
+        if (matchCount < 1) {
+            printf("soTran phải lớn hơn 0\nCách dùng: chaynhieutran --scaling [soTran]\n");
+            return 1;
+        }
+        printf("%6s %12s %8s\n", "luong", "tran/giay", "tang toc");
+        double baseRate = 0;
+        for (int threads = 1; threads <= maxThreads; threads++) {
+            double seconds = runBatch(matchCount, threads, results);
+            double rate = matchCount / seconds;
+            if (threads == 1) baseRate = rate;
+            printf("%6d %12.0f %7.2fx\n", threads, rate, rate / baseRate);
+        }
+        return 0;
+    }
+
+    int matchCount = argc > 1 ? atoi(argv[1]) : 1000;
+    int threadCount = argc > 2 ? atoi(argv[2]) : maxThreads;
+    const char* outPath = argc > 3 ? argv[3] : "ketqua.csv";
+    if (matchCount < 1 || threadCount < 1) {
+        printf("soTran và soLuong phải lớn hơn 0\nCách dùng: chaynhieutran [soTran] [soLuong] [fileKetQua]\n");
+        return 1;
+    }
+
+    double seconds = runBatch(matchCount, threadCount, results);
+
+    int wins[3] = {0, 0, 0};
+    for (const auto& r : results)
+        wins[r.winner]++;
+    printf("%d trận, %d luồng, %.3f s (%.0f trận/giây)\n", matchCount, threadCount, seconds, matchCount / seconds);
+    printf("người chơi thắng: %d, xe địch thắng: %d, hòa: %d\n", wins[1], wins[2], wins[0]);
+    if (!writeResults(outPath, results)) {
+        printf("Không ghi được file kết quả %s\n", outPath);
+        return 1;
+    }
+    printf("Đã ghi kết quả vào %s\n", outPath);
+    return 0;
+}
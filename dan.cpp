@@ -0,0 +1,52 @@
+#include "mophong.h"
+
+void initBulletPool(BulletPool& pool, int capacity) {
+    pool.capacity = capacity;
+    pool.count = 0;
+    pool.x.assign(capacity, 0);
+    pool.y.assign(capacity, 0);
+    pool.w.assign(capacity, 0);
+    pool.h.assign(capacity, 0);
+    pool.dx.assign(capacity, 0);
+    pool.dy.assign(capacity, 0);
+    pool.remX.assign(capacity, 0);
+    pool.remY.assign(capacity, 0);
+    pool.large.assign(capacity, 0);
+    pool.isEnemy.assign(capacity, 0);
+}
+
+bool addBullet(BulletPool& pool, const Bullet& bullet) {
+    if (pool.count >= pool.capacity) return false;
+    int i = pool.count++;
+    pool.x[i] = bullet.rect.x;
+    pool.y[i] = bullet.rect.y;
+    pool.w[i] = bullet.rect.w;
+    pool.h[i] = bullet.rect.h;
+    pool.dx[i] = bullet.dx;
+    pool.dy[i] = bullet.dy;
+    pool.remX[i] = 0;
+    pool.remY[i] = 0;
+    pool.large[i] = bullet.large;
+    pool.isEnemy[i] = bullet.isEnemy;
+    return true;
+}
+
+void removeBulletAt(BulletPool& pool, int i) {
+    int last = --pool.count;
+    if (i == last) return;
+    pool.x[i] = pool.x[last];
+    pool.y[i] = pool.y[last];
+    pool.w[i] = pool.w[last];
+    pool.h[i] = pool.h[last];
+    pool.dx[i] = pool.dx[last];
+    pool.dy[i] = pool.dy[last];
+    pool.remX[i] = pool.remX[last];
+    pool.remY[i] = pool.remY[last];
+    pool.large[i] = pool.large[last];
+    pool.isEnemy[i] = pool.isEnemy[last];
+}
+
+Rect bulletRect(const BulletPool& pool, int i) {
+    Rect rect = {pool.x[i], pool.y[i], pool.w[i], pool.h[i]};
+    return rect;
+}
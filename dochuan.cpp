@@ -0,0 +1,219 @@
+// Đo chuẩn các phần nóng của lõi mô phỏng: checkCollision, một lượt updateBullets() với
+// 10 / 1000 / 100000 viên đạn, moveEnemies() với 5 / 1000 / 10000 xe địch và một chuỗi nổ
+// dây chuyền. Kết quả ra JSON (ns mỗi lần gọi, số phần tử mỗi giây) để so trước và sau
+// khi sửa các phần này.
+// Mỗi phép đo chạy một lô khởi động không tính giờ, rồi SAMPLES mẫu, mỗi mẫu ít nhất
+// SAMPLE_NS; ns/op là trung vị của các mẫu.
+// Phần chuẩn bị (nạp lại đạn, dựng lại bản đồ nổ) không tính giờ.
+// Biên dịch: g++ -O2 dochuan.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp -o dochuan
+// Cách dùng: dochuan             (JSON ra màn hình)
+//            dochuan ketqua.json (JSON ra file, bảng tóm tắt ra màn hình)
+#include "mophong.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+const int SAMPLES = 5;
+const double SAMPLE_NS = 50e6;
+
+struct Result {
+    const char* name;
+    int size;           // Số đạn / xe địch / ô nổ của phép đo
+    long long ops;      // Tổng số lần gọi đã đo
+    double nsPerOp;     // Trung vị các mẫu
+    double nsMin, nsMax;
+    double itemsPerSec; // Số phần tử (đạn, xe, ô, cặp hình) xử lý mỗi giây
+};
+
+std::vector<Result> results;
+Rng rng; // Sinh dữ liệu đo, tách khỏi Rng của World
+volatile long long sink = 0;
+
+// Đo run(): mỗi lô gọi prepare() (không tính giờ) rồi opsPerBatch lần run(), run trả về
+// số phần tử đã xử lý trong lần gọi đó
+template <typename Prepare, typename Run>
+void measure(const char* name, int size, int opsPerBatch, Prepare prepare, Run run) {
+    double samples[SAMPLES];
+    long long totalOps = 0, totalItems = 0;
+    double totalNs = 0;
+    // Lô khởi động: nạp cache, dự đoán rẽ nhánh và tần số CPU trước mẫu đầu tiên
+    prepare();
+    for (int i = 0; i < opsPerBatch; i++)
+        run();
+    for (int s = 0; s < SAMPLES; s++) {
+        long long ops = 0;
+        double ns = 0;
+        while (ns < SAMPLE_NS) {
+            prepare();
+            long long items = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < opsPerBatch; i++)
+                items += run();
+            auto end = std::chrono::steady_clock::now();
+            ns += std::chrono::duration<double, std::nano>(end - start).count();
+            ops += opsPerBatch;
+            totalItems += items;
+        }
+        samples[s] = ns / ops;
+        totalOps += ops;
+        totalNs += ns;
+    }
+    std::sort(samples, samples + SAMPLES);
+    results.push_back({name, size, totalOps, samples[SAMPLES / 2], samples[0], samples[SAMPLES - 1],
+                       totalItems / (totalNs / 1e9)});
+}
+
+// checkCollision trên các cặp hình ngẫu nhiên cỡ xe tăng và đạn, khoảng một nửa số cặp chồng nhau.
+// Mỗi lô đi qua đúng PAIRS cặp dựng sẵn theo thứ tự; số lần trúng cộng vào biến cục bộ và
+// chỉ ghi ra sink một lần sau khi đo, để vòng đo chỉ còn lời gọi checkCollision.
+void benchCollision() {
+    const int PAIRS = 4096;
+    std::vector<Rect> a(PAIRS), b(PAIRS);
+    for (int i = 0; i < PAIRS; i++) {
+        a[i] = {(int)randomBelow(rng, 4 * CELL_SIZE), (int)randomBelow(rng, 4 * CELL_SIZE), TANK_SIZE, TANK_SIZE};
+        b[i] = {(int)randomBelow(rng, 4 * CELL_SIZE), (int)randomBelow(rng, 4 * CELL_SIZE), BULLET_SIZE_SMALL, BULLET_SIZE_SMALL};
+    }
+    const Rect* pairA = a.data();
+    const Rect* pairB = b.data();
+    int next = 0;
+    long long hits = 0;
+    measure("checkCollision", 1, PAIRS, [&] { next = 0; }, [&] {
+        hits += checkCollision(pairA[next], pairB[next]);
+        next++;
+        return 1;
+    });
+    sink = sink + hits;
+}
+
+// Thêm đạn ở tâm các ô trên hàng/cột chẵn (đường đi không có chướng ngại vật) cho đủ count viên;
+// đạn của người chơi và xe địch, cả hai cỡ
+void refillBullets(World& world, int count) {
+    while (world.bullets.count < count) {
+        Bullet bullet;
+        bool horizontal = randomBelow(rng, 2) == 0;
+        int cx = randomBelow(rng, world.cols);
+        int cy = randomBelow(rng, world.rows);
+        if (horizontal) cy -= cy % 2; else cx -= cx % 2;
+        bullet.large = randomBelow(rng, 8) == 0;
+        int size = bullet.large ? BULLET_SIZE_LARGE : BULLET_SIZE_SMALL;
+        int speed = bullet.large ? BULLET_SPEED_LARGE : BULLET_SPEED_SMALL;
+        if (randomBelow(rng, 2)) speed = -speed;
+        bullet.rect = {cx * CELL_SIZE + TANK_SIZE / 2 - size / 2, cy * CELL_SIZE + TANK_SIZE / 2 - size / 2, size, size};
+        bullet.dx = horizontal ? speed : 0;
+        bullet.dy = horizontal ? 0 : speed;
+        bullet.isEnemy = randomBelow(rng, 2) == 0;
+        addBullet(world.bullets, bullet);
+    }
+}
+
+// Một lượt updateBullets() với count viên đạn trên bản đồ side x side có xe địch trên
+// 1/16 số ô. Đạn trúng vật bị xóa nên mỗi lô 8 lượt mới nạp lại; số phần tử là số đạn
+// thực có ở đầu mỗi lượt. Cứ 64 lô dựng lại bản đồ vì đạn phá dần chướng ngại vật.
+void benchBullets(int count, int side) {
+    World world;
+    initBulletPool(world.bullets, std::max(count, MAX_BULLETS)); // initWorld giữ kho đã cấp phát
+    initWorld(world, side, side, side * side / 16, 1234);
+    int batches = 0;
+    measure("updateBullets", count, 8, [&] {
+        if (++batches % 64 == 0) initWorld(world, side, side, side * side / 16, 1234);
+        refillBullets(world, count);
+    }, [&] {
+        int before = world.bullets.count;
+        updateBullets(world);
+        return before;
+    });
+}
+
+// moveEnemies() với count xe địch, ép mọi xe di chuyển ở mỗi lần gọi (trường hợp nặng nhất)
+void benchEnemies(int count) {
+    World world;
+    if (count == ENEMY_COUNT) initWorld(world, 1234);
+    else {
+        int side = 2;
+        while ((side / 2) * (side / 2) - 1 < count) side += 2; // Đủ ô chẵn cho count xe
+        initWorld(world, side, side, count, 1234);
+    }
+    measure("moveEnemies", world.enemies.count, 16, [] {}, [&] {
+        std::fill(world.enemies.nextMove.begin(), world.enemies.nextMove.end(), world.timeMs);
+        moveEnemies(world);
+        return world.enemies.count;
+    });
+}
+
+// Nổ dây chuyền: mọi ô trống của bản đồ side x side là ô nổ, một tên lửa của người chơi
+// trúng một ô và cả bản đồ nổ theo. Đo một lượt updateBullets() (gồm xử lý mọi vụ nổ);
+// số phần tử là số ô bị phá.
+void benchExplosions(int side) {
+    World world;
+    int tiles = 0;
+    auto setup = [&] {
+        initWorld(world, side, side, side * side / 16, 1234);
+        tiles = 0;
+        for (int cy = 0; cy < side; cy++) {
+            for (int cx = 0; cx < side; cx++) {
+                if (cellContents(world, cx, cy) & (CELL_ENEMY | CELL_PLAYER)) continue;
+                addExplosiveTile(world, cx, cy);
+                tiles++;
+            }
+        }
+        // Tên lửa bay sang phải, sát cạnh trái của ô nổ (1, rows - 1) cạnh xe người chơi
+        Bullet missile;
+        missile.rect = {CELL_SIZE - BULLET_SIZE_LARGE, (side - 1) * CELL_SIZE + TANK_SIZE / 2 - BULLET_SIZE_LARGE / 2,
+                        BULLET_SIZE_LARGE, BULLET_SIZE_LARGE};
+        missile.dx = BULLET_SPEED_LARGE;
+        missile.dy = 0;
+        missile.large = true;
+        missile.isEnemy = false;
+        addBullet(world.bullets, missile);
+    };
+    measure("explosionChain", side * side, 1, setup, [&] {
+        updateBullets(world);
+        return tiles;
+    });
+    // Kiểm tra chuỗi nổ thật sự lan hết bản đồ, nếu không số đo vô nghĩa
+    setup();
+    updateBullets(world);
+    if (countCells(world.obstacleBits) != 0)
+        fprintf(stderr, "explosionChain %dx%d: con %d o chua no\n", side, side, countCells(world.obstacleBits));
+}
+
+void writeJson(FILE* out) {
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(out, "    {\"name\": \"%s\", \"size\": %d, \"ops\": %lld, \"ns_per_op\": %.2f, \"ns_per_op_min\": %.2f, "
+                     "\"ns_per_op_max\": %.2f, \"items_per_sec\": %.0f}%s\n",
+                r.name, r.size, r.ops, r.nsPerOp, r.nsMin, r.nsMax, r.itemsPerSec, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char* argv[]) {
+    seedRng(rng, 1234);
+    benchCollision();
+    benchBullets(10, GRID_SIZE);
+    benchBullets(1000, 64);
+    benchBullets(100000, 400);
+    benchEnemies(ENEMY_COUNT);
+    benchEnemies(1000);
+    benchEnemies(10000);
+    benchExplosions(32);
+    benchExplosions(128);
+
+    if (argc < 2) {
+        writeJson(stdout);
+        return 0;
+    }
+    FILE* file = fopen(argv[1], "w");
+    if (!file) {
+        printf("Không ghi được file %s\n", argv[1]);
+        return 1;
+    }
+    writeJson(file);
+    fclose(file);
+    printf("%-16s %8s %14s %14s %16s\n", "phep do", "co", "ns/op", "min-max", "phan tu/giay");
+    for (const Result& r : results)
+        printf("%-16s %8d %14.1f %6.0f-%-7.0f %16.3g\n", r.name, r.size, r.nsPerOp, r.nsMin, r.nsMax, r.itemsPerSec);
+    return 0;
+}
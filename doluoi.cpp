@@ -0,0 +1,140 @@
+// Đo thời gian updateBullets() khi số chướng ngại vật và xe địch tăng dần,
+// so với cách cũ quét mọi vật thể cho từng viên đạn, và thời gian một tick
+// updateWorld() đầy đủ khi mọi xe địch cùng di chuyển và bắn trong tick đó
+// (kèm số đạn updateBullets() xử lý trung bình mỗi tick và số đạn bị bỏ vì kho đầy), và
+// thời gian tick trung bình/chậm nhất khi xe di chuyển và bắn theo nhịp thật (đồng hồ lệch pha).
+// Biên dịch: g++ -O2 doluoi.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp -o doluoi
+#include "mophong.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+const int BULLET_COUNT = 256; // Số đạn luôn giữ trên bản đồ
+const int TICKS = 100;
+const int REAL_TICKS = 3 * ENEMY_SHOOT_DELAY / TICK_MS; // Ba giây chơi thật, gồm mọi pha bắn
+
+Rng rng; // Sinh vị trí đạn, tách khỏi Rng của World
+
+// Thêm đạn nhỏ tại vị trí ngẫu nhiên trên các hàng/cột chẵn cho đủ BULLET_COUNT
+void refillBullets(World& world) {
+    while (world.bullets.count < BULLET_COUNT) {
+        Bullet bullet;
+        bool horizontal = randomBelow(rng, 2) == 0;
+        int cx = randomBelow(rng, world.cols);
+        int cy = randomBelow(rng, world.rows);
+        if (horizontal) cy -= cy % 2; else cx -= cx % 2;
+        int speed = randomBelow(rng, 2) ? BULLET_SPEED_SMALL : -BULLET_SPEED_SMALL;
+        bullet.rect = {cx * CELL_SIZE + TANK_SIZE / 2 - BULLET_SIZE_SMALL / 2,
+                       cy * CELL_SIZE + TANK_SIZE / 2 - BULLET_SIZE_SMALL / 2,
+                       BULLET_SIZE_SMALL, BULLET_SIZE_SMALL};
+        bullet.dx = horizontal ? speed : 0;
+        bullet.dy = horizontal ? 0 : speed;
+        bullet.large = false;
+        bullet.isEnemy = randomBelow(rng, 2) == 0;
+        addBullet(world.bullets, bullet);
+    }
+}
+
+// Danh sách hình chữ nhật chướng ngại vật như cách lưu cũ (mảng SDL_Rect)
+std::vector<Rect> obstacleRects;
+
+// Bộ nhớ của các lớp lưới (KB): chỉ gồm các khối đã cấp phát
+double gridKB(const World& world) {
+    size_t bytes = 0;
+    const BitGrid* layers[] = {&world.obstacleBits, &world.enemyBits, &world.playerBits, &world.explosiveBits};
+    for (const BitGrid* layer : layers)
+        bytes += layer->words.size() * sizeof(unsigned long long) + layer->chunkOffset.size() * sizeof(int);
+    bytes += (world.enemyGrid.cellHead.size() + world.enemyGrid.chunkOffset.size()) * sizeof(int);
+    return bytes / 1024.0;
+}
+
+// Cách cũ: mỗi viên đạn kiểm tra với mọi chướng ngại vật và mọi xe địch
+int bruteForceHits(const World& world) {
+    int hits = 0;
+    for (int i = 0; i < world.bullets.count; i++) {
+        Rect rect = bulletRect(world.bullets, i);
+        for (const auto& obstacle : obstacleRects) {
+            if (obstacle.w > 0 && checkCollision(rect, obstacle)) { hits++; break; }
+        }
+        for (int e = 0; e < world.enemies.count; e++) {
+            if (checkCollision(rect, enemyRect(world.enemies, e))) { hits++; break; }
+        }
+    }
+    return hits;
+}
+
+int main() {
+    const int sides[] = {12, 40, 128, 400};
+    printf("%8s %12s %10s %16s %18s %16s %12s %10s %16s %16s %12s\n", "ban do", "chuong ngai", "xe dich",
+           "luoi (ns/tick)", "quet het (ns/tick)", "ca tick (us)", "dan/tick", "dan bo", "nhip that (us)",
+           "that max (us)", "luoi (KB)");
+
+    for (int side : sides) {
+        seedRng(rng, 1234);
+        World world;
+        initWorld(world, side, side, side * side / 16, 1234);
+        int obstacleCount = countCells(world.obstacleBits);
+        obstacleRects.clear();
+        for (int cell = nextSetCell(world.obstacleBits, 0); cell != -1; cell = nextSetCell(world.obstacleBits, cell + 1))
+            obstacleRects.push_back({cellX(world, cell) * CELL_SIZE, cellY(world, cell) * CELL_SIZE, CELL_SIZE, CELL_SIZE});
+        int enemyCount = world.enemies.count;
+
+        double gridNs = 0, bruteNs = 0;
+        volatile int sink = 0;
+        for (int t = 0; t < TICKS; t++) {
+            refillBullets(world);
+
+            auto start = std::chrono::steady_clock::now();
+            sink = sink + bruteForceHits(world);
+            auto mid = std::chrono::steady_clock::now();
+            updateBullets(world);
+            auto end = std::chrono::steady_clock::now();
+
+            bruteNs += std::chrono::duration<double, std::nano>(mid - start).count();
+            gridNs += std::chrono::duration<double, std::nano>(end - mid).count();
+        }
+
+        // Cả tick: ép mọi xe địch di chuyển và bắn ở mỗi tick (trường hợp nặng nhất).
+        // Kho đạn của initWorld tính cho nhịp bắn 1 giây, nên nới cho đủ mỗi xe một
+        // viên mỗi tick, để không viên nào bị bỏ và phép đo gồm đủ số đạn thật.
+        initBulletPool(world.bullets, enemyCount * TICKS + BULLET_COUNT);
+        world.droppedBullets = 0;
+        double tickNs = 0;
+        long long sweptBullets = 0;
+        for (int t = 0; t < TICKS; t++) {
+            refillBullets(world);
+            std::fill(world.enemies.nextMove.begin(), world.enemies.nextMove.end(), world.timeMs);
+            std::fill(world.enemies.nextShoot.begin(), world.enemies.nextShoot.end(), world.timeMs);
+            // Đạn có sẵn cộng một viên của mỗi xe (moveEnemies không giết xe nào)
+            sweptBullets += world.bullets.count + world.enemies.count;
+            unsigned int droppedBefore = world.droppedBullets;
+            auto start = std::chrono::steady_clock::now();
+            updateWorld(world);
+            auto end = std::chrono::steady_clock::now();
+            tickNs += std::chrono::duration<double, std::nano>(end - start).count();
+            sweptBullets -= world.droppedBullets - droppedBefore;
+        }
+
+        unsigned int dropped = world.droppedBullets;
+        double kb = gridKB(world);
+
+        // Nhịp thật: trận mới, không ép gì, đạn tích lũy tự nhiên; tick chậm nhất là tick nặng
+        // nhất trong mọi pha bắn và di chuyển của các xe
+        initWorld(world, side, side, side * side / 16, 1234);
+        double realNs = 0, realMaxNs = 0;
+        for (int t = 0; t < REAL_TICKS; t++) {
+            auto start = std::chrono::steady_clock::now();
+            updateWorld(world);
+            auto end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            realNs += ns;
+            realMaxNs = std::max(realMaxNs, ns);
+        }
+
+        printf("%5dx%-3d %12d %10d %16.0f %18.0f %16.1f %12lld %10u %16.1f %16.1f %12.1f\n", side, side, obstacleCount,
+               enemyCount, gridNs / TICKS, bruteNs / TICKS, tickNs / TICKS / 1000, sweptBullets / TICKS, dropped,
+               realNs / REAL_TICKS / 1000, realMaxNs / 1000, kb);
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Đóng gói tài nguyên (chạy một lần khi build, mỗi khi đổi ảnh hoặc âm thanh): đọc các
+// ảnh PNG và file WAV, thu ảnh về đúng cỡ vẽ trong game, xếp thành tập ảnh (kể cả bản
+// xoay của xe tăng) theo định dạng điểm ảnh của texture, đổi âm thanh sang PCM 44100 Hz
+// 16 bit 2 kênh, rồi ghi tất cả vào một gói (goi.h) để game mở bằng mmap.
+// Biên dịch: g++ -O2 donggoi.cpp goi.cpp tapanh.cpp -lSDL2main -lSDL2 -lSDL2_image -o donggoi
+// Cách dùng: donggoi [tainguyen.pak]
+#include <SDL.h>
+#include <SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "goi.h"
+#include "mophong.h" // Cỡ vẽ: TANK_SIZE, CELL_SIZE, BULLET_SIZE_*
+#include "tapanh.h"
+
+// Định dạng điểm ảnh mà các renderer của SDL (Direct3D, OpenGL, phần mềm) dùng đầu tiên,
+// nên SDL_UpdateTexture chép thẳng không phải đổi
+const Uint32 PACK_PIXEL_FORMAT = SDL_PIXELFORMAT_ARGB8888;
+
+struct ImageAsset {
+    const char* path;
+    const char* name;
+    int size;          // Cỡ vẽ trong game (pixel, hình vuông)
+    bool directional;  // Chỉ quay 4 hướng: xếp thêm 3 bản xoay sẵn
+};
+
+struct SoundAsset {
+    const char* path;
+    const char* name;
+};
+
+const ImageAsset IMAGES[] = {
+    {"tank.png", "tank", TANK_SIZE, true},
+    {"tank2.png", "tank2", TANK_SIZE, true},
+    {"obstacle.png", "obstacle", CELL_SIZE, false},
+    {"dan.png", "dan", BULLET_SIZE_SMALL, false},
+    {"tenlua.png", "tenlua", BULLET_SIZE_LARGE, false},
+};
+const int IMAGE_COUNT = sizeof(IMAGES) / sizeof(IMAGES[0]);
+
+const SoundAsset SOUNDS[] = {
+    {"pim (audio-extractor.net).wav", "pim"},
+    {"pà (audio-extractor.net).wav", "pa"},
+    {"vỡ gạch (audio-extractor.net).wav", "vogach"},
+    {"ư (audio-extractor.net).wav", "u"},
+};
+const int SOUND_COUNT = sizeof(SOUNDS) / sizeof(SOUNDS[0]);
+
+// Thu ảnh RGBA32 source về w x h: mỗi điểm ảnh mới là trung bình các điểm ảnh gốc nó phủ
+// (nhân alpha trước khi cộng để viền trong suốt không làm tối màu); phóng to thì lấy điểm gần nhất
+static SDL_Surface* scaleImage(SDL_Surface* source, int w, int h) {
+    SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!scaled) return nullptr;
+    for (int y = 0; y < h; y++) {
+        int y0 = y * source->h / h;
+        int y1 = std::max(y0 + 1, ((y + 1) * source->h + h - 1) / h);
+        Uint8* out = (Uint8*)scaled->pixels + y * scaled->pitch;
+        for (int x = 0; x < w; x++) {
+            int x0 = x * source->w / w;
+            int x1 = std::max(x0 + 1, ((x + 1) * source->w + w - 1) / w);
+            double r = 0, g = 0, b = 0, a = 0;
+            for (int sy = y0; sy < y1; sy++) {
+                const Uint8* row = (const Uint8*)source->pixels + sy * source->pitch;
+                for (int sx = x0; sx < x1; sx++) {
+                    const Uint8* p = row + sx * 4;
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                }
+            }
+            int samples = (y1 - y0) * (x1 - x0);
+            out[x * 4 + 0] = a > 0 ? (Uint8)(r / a + 0.5) : 0;
+            out[x * 4 + 1] = a > 0 ? (Uint8)(g / a + 0.5) : 0;
+            out[x * 4 + 2] = a > 0 ? (Uint8)(b / a + 0.5) : 0;
+            out[x * 4 + 3] = (Uint8)(a / samples + 0.5);
+        }
+    }
+    return scaled;
+}
+
+// Đọc một file WAV và đổi sang định dạng PCM của gói; false nếu không đọc được
+static bool addSound(PackBuilder& builder, const SoundAsset& asset) {
+    SDL_AudioSpec spec;
+    Uint8* buffer = nullptr;
+    Uint32 length = 0;
+    if (!SDL_LoadWAV(asset.path, &spec, &buffer, &length)) return false;
+
+    SDL_AudioCVT cvt;
+    int built = SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                                  AUDIO_S16SYS, PACK_AUDIO_CHANNELS, PACK_AUDIO_FREQUENCY);
+    bool ok = built >= 0;
+    if (ok) {
+        std::vector<Uint8> pcm((size_t)length * cvt.len_mult);
+        memcpy(pcm.data(), buffer, length);
+        cvt.buf = pcm.data();
+        cvt.len = length;
+        if (built > 0) ok = SDL_ConvertAudio(&cvt) == 0;
+        else cvt.len_cvt = length;
+        if (ok) {
+            addPackEntry(builder, asset.name, PACK_SOUND, pcm.data(), cvt.len_cvt, AUDIO_S16SYS,
+                         PACK_AUDIO_FREQUENCY, PACK_AUDIO_CHANNELS, 0);
+        }
+    }
+    SDL_FreeWAV(buffer);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    const char* output = argc > 1 ? argv[1] : "tainguyen.pak";
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        printf("SDL_image không khởi tạo được: %s\n", IMG_GetError());
+        return 1;
+    }
+
+    // Ảnh: giải mã, thu về cỡ vẽ rồi xếp thành tập ảnh
+    SDL_Surface* images[IMAGE_COUNT] = {};
+    const char* names[IMAGE_COUNT];
+    bool directional[IMAGE_COUNT];
+    for (int i = 0; i < IMAGE_COUNT; i++) {
+        names[i] = IMAGES[i].name;
+        directional[i] = IMAGES[i].directional;
+        SDL_Surface* loaded = IMG_Load(IMAGES[i].path);
+        if (!loaded) {
+            printf("bỏ qua %s: %s\n", IMAGES[i].path, IMG_GetError());
+            continue;
+        }
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (!converted) continue;
+        images[i] = scaleImage(converted, IMAGES[i].size, IMAGES[i].size);
+        SDL_FreeSurface(converted);
+    }
+
+    Atlas atlas;
+    SDL_Surface* sheet = packAtlas(atlas, images, names, IMAGE_COUNT, directional);
+    for (SDL_Surface* image : images)
+        SDL_FreeSurface(image);
+    SDL_Surface* packed = sheet ? SDL_ConvertSurfaceFormat(sheet, PACK_PIXEL_FORMAT, 0) : nullptr;
+    SDL_FreeSurface(sheet);
+    if (!packed) {
+        printf("Không xếp được tập ảnh\n");
+        IMG_Quit();
+        return 1;
+    }
+
+    PackBuilder builder;
+    savePackAtlas(builder, atlas, packed);
+    printf("tap anh: %dx%d, %d vung\n", packed->w, packed->h, (int)atlas.sprites.size());
+    SDL_FreeSurface(packed);
+
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (!addSound(builder, SOUNDS[i]))
+            printf("bỏ qua %s: %s\n", SOUNDS[i].path, SDL_GetError());
+    }
+
+    bool ok = savePack(builder, output);
+    printf(ok ? "đã ghi %s (%d mục)\n" : "không ghi được %s (%d mục)\n", output, (int)builder.entries.size());
+    IMG_Quit();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// So sánh nhân va chạm AABB theo lô (vacham.h) với vòng lặp checkCollision từng cặp.
+// Biên dịch: g++ -O2 dovacham.cpp vacham.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp -o dovacham
+#include "vacham.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+const int BOX_COUNT = 4096;   // Số hộp b (ví dụ: đạn)
+const int QUERY_COUNT = 1024; // Số hộp a cho phép thử nhiều-với-nhiều
+
+std::vector<int> xs, ys, ws, hs;
+
+// Cách cũ: gọi checkCollision cho từng cặp
+void scalarBaseline(const std::vector<Rect>& queries, std::vector<unsigned int>& mask) {
+    int words = maskWords(BOX_COUNT);
+    for (int q = 0; q < (int)queries.size(); q++) {
+        unsigned int* row = &mask[(size_t)q * words];
+        for (int i = 0; i < words; i++) row[i] = 0;
+        for (int i = 0; i < BOX_COUNT; i++) {
+            Rect b = {xs[i], ys[i], ws[i], hs[i]};
+            if (checkCollision(queries[q], b))
+                row[i >> 5] |= 1u << (i & 31);
+        }
+    }
+}
+
+int main() {
+    srand(99);
+    for (int i = 0; i < BOX_COUNT; i++) {
+        xs.push_back(rand() % SCREEN_WIDTH);
+        ys.push_back(rand() % SCREEN_HEIGHT);
+        ws.push_back(BULLET_SIZE_SMALL);
+        hs.push_back(BULLET_SIZE_SMALL);
+    }
+    std::vector<Rect> queries;
+    std::vector<int> qx, qy, qw, qh;
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        Rect a = {rand() % SCREEN_WIDTH, rand() % SCREEN_HEIGHT, TANK_SIZE, TANK_SIZE};
+        queries.push_back(a);
+        qx.push_back(a.x); qy.push_back(a.y); qw.push_back(a.w); qh.push_back(a.h);
+    }
+
+    const double pairs = (double)QUERY_COUNT * BOX_COUNT;
+    std::vector<unsigned int> expected((size_t)QUERY_COUNT * maskWords(BOX_COUNT));
+    std::vector<unsigned int> mask(expected.size());
+
+    auto start = std::chrono::steady_clock::now();
+    scalarBaseline(queries, expected);
+    auto end = std::chrono::steady_clock::now();
+    double baseNs = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-16s %10.3f ns/cap %8s\n", "checkCollision", baseNs / pairs, "1.00x");
+
+    const CollisionKernel kernels[] = {KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2};
+    for (CollisionKernel kernel : kernels) {
+        if (!setCollisionKernel(kernel)) {
+            printf("%-16s (CPU không hỗ trợ)\n", collisionKernelName(kernel));
+            continue;
+        }
+        start = std::chrono::steady_clock::now();
+        collideManyToMany(qx.data(), qy.data(), qw.data(), qh.data(), QUERY_COUNT,
+                          xs.data(), ys.data(), ws.data(), hs.data(), BOX_COUNT, mask.data());
+        end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        bool same = mask == expected;
+        printf("%-16s %10.3f ns/cap %7.2fx %s\n", collisionKernelName(kernel), ns / pairs, baseNs / ns,
+               same ? "" : "(KẾT QUẢ SAI)");
+    }
+    return 0;
+}
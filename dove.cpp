@@ -0,0 +1,88 @@
+// So sánh vẽ 10000 hình xe tăng bằng SDL_RenderCopyEx từng hình với vẽ theo lô
+// (velo.h, một lệnh SDL_RenderGeometry cho cả lô). In số lệnh vẽ và thời gian mỗi khung.
+// Biên dịch: g++ -O2 dove.cpp velo.cpp -lSDL2main -lSDL2 -lSDL2_image -o dove
+// Cách dùng: dove [soHinh] [soKhung]
+#include <SDL.h>
+#include <SDL_image.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "velo.h"
+
+const int WIDTH = 840;
+const int HEIGHT = 840;
+const int SPRITE_SIZE = 35;
+
+struct Sprite {
+    SDL_Rect rect;
+    double angle;
+};
+
+// Vẽ frameCount khung, trả về thời gian trung bình mỗi khung (ms)
+template <typename DrawFrame>
+double timeFrames(SDL_Renderer* renderer, int frameCount, DrawFrame drawFrame) {
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int f = 0; f < frameCount; f++) {
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        drawFrame();
+        SDL_RenderPresent(renderer);
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency / frameCount;
+}
+
+int main(int argc, char* argv[]) {
+    int spriteCount = argc > 1 ? atoi(argv[1]) : 10000;
+    int frameCount = argc > 2 ? atoi(argv[2]) : 200;
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) return 1;
+    IMG_Init(IMG_INIT_PNG);
+    SDL_Window* window = SDL_CreateWindow("dove", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                          WIDTH, HEIGHT, SDL_WINDOW_SHOWN);
+    // Không bật vsync để đo đúng thời gian vẽ
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Surface* surface = IMG_Load("tank.png");
+    if (!window || !renderer || !surface) {
+        printf("Không khởi tạo được SDL hoặc không đọc được tank.png\n");
+        return 1;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+
+    srand(7);
+    std::vector<Sprite> sprites(spriteCount);
+    for (Sprite& sprite : sprites) {
+        sprite.rect = {rand() % (WIDTH - SPRITE_SIZE), rand() % (HEIGHT - SPRITE_SIZE), SPRITE_SIZE, SPRITE_SIZE};
+        sprite.angle = (rand() % 4) * 90.0;
+    }
+
+    double copyMs = timeFrames(renderer, frameCount, [&]() {
+        for (const Sprite& sprite : sprites)
+            SDL_RenderCopyEx(renderer, texture, nullptr, &sprite.rect, sprite.angle, nullptr, SDL_FLIP_NONE);
+    });
+
+    SpriteBatch batch;
+    int batchCalls = 0;
+    const SDL_Color white = {255, 255, 255, 255};
+    double batchMs = timeFrames(renderer, frameCount, [&]() {
+        beginBatch(batch, texture);
+        for (const Sprite& sprite : sprites)
+            addSprite(batch, sprite.rect, sprite.angle, white);
+        batchCalls = flushBatch(renderer, batch);
+    });
+
+    SDL_RendererInfo info;
+    SDL_GetRendererInfo(renderer, &info);
+    printf("renderer: %s, %d hinh, %d khung\n", info.name, spriteCount, frameCount);
+    printf("%-18s %10s %12s\n", "cach ve", "lenh/khung", "ms/khung");
+    printf("%-18s %10d %12.3f\n", "RenderCopyEx", spriteCount, copyMs);
+    printf("%-18s %10d %12.3f\n", "RenderGeometry", batchCalls, batchMs);
+
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
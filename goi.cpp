@@ -0,0 +1,177 @@
+#include "goi.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char PACK_MAGIC[4] = {'B', 'C', 'A', 'P'};
+static const size_t PACK_ALIGN = 16;
+
+bool mapFile(MappedFile& file, const char* path) {
+    unmapFile(file);
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle); // Ánh xạ giữ file mở
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    file.data = (const unsigned char*)view;
+    file.size = (size_t)size.QuadPart;
+    file.mapping = mapping;
+    return true;
+#else
+    int handle = open(path, O_RDONLY);
+    if (handle < 0) return false;
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(handle, &info) == 0 && info.st_size > 0)
+        view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+    close(handle); // Ánh xạ giữ file mở
+    if (view == MAP_FAILED) return false;
+    file.data = (const unsigned char*)view;
+    file.size = info.st_size;
+    return true;
+#endif
+}
+
+void unmapFile(MappedFile& file) {
+    if (file.data) {
+#ifdef _WIN32
+        UnmapViewOfFile(file.data);
+        CloseHandle((HANDLE)file.mapping);
+#else
+        munmap((void*)file.data, file.size);
+#endif
+    }
+    file.data = nullptr;
+    file.size = 0;
+    file.mapping = nullptr;
+}
+
+void releasePages(const MappedFile& file, size_t offset, size_t size) {
+    if (!file.data || offset >= file.size) return;
+    size = std::min(size, file.size - offset);
+#ifdef _WIN32
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    size_t page = system.dwPageSize;
+#else
+    size_t page = sysconf(_SC_PAGESIZE);
+#endif
+    // Chỉ các trang nằm trọn trong khoảng: trang đầu và cuối có thể còn dữ liệu đang dùng
+    uintptr_t begin = ((uintptr_t)file.data + offset + page - 1) / page * page;
+    uintptr_t end = ((uintptr_t)file.data + offset + size) / page * page;
+    if (end <= begin) return;
+#ifdef _WIN32
+    // Bỏ khóa trang chưa khóa thì Windows gỡ trang khỏi working set (hàm báo lỗi, bỏ qua)
+    VirtualUnlock((void*)begin, end - begin);
+#else
+    madvise((void*)begin, end - begin, MADV_DONTNEED);
+#endif
+}
+
+bool openPack(AssetPack& pack, const char* path) {
+    closePack(pack);
+    if (!mapFile(pack.file, path)) return false;
+
+    // Kiểm tra đầu file và bảng mục để mọi con trỏ lấy ra sau này đều nằm trong file
+    const MappedFile& file = pack.file;
+    bool ok = file.size >= sizeof(PackHeader);
+    const PackHeader* header = (const PackHeader*)file.data;
+    ok = ok && memcmp(header->magic, PACK_MAGIC, 4) == 0 && header->version == PACK_VERSION &&
+         header->entryCount <= (file.size - sizeof(PackHeader)) / sizeof(PackEntry);
+    if (ok) {
+        pack.entries = (const PackEntry*)(file.data + sizeof(PackHeader));
+        pack.entryCount = header->entryCount;
+        for (int i = 0; i < pack.entryCount && ok; i++) {
+            const PackEntry& entry = pack.entries[i];
+            ok = memchr(entry.name, '\0', sizeof(entry.name)) != nullptr && entry.offset % PACK_ALIGN == 0 &&
+                 entry.offset <= file.size && entry.size <= file.size - entry.offset;
+        }
+    }
+    if (!ok) closePack(pack);
+    return ok;
+}
+
+void closePack(AssetPack& pack) {
+    unmapFile(pack.file);
+    pack.entries = nullptr;
+    pack.entryCount = 0;
+}
+
+void touchPack(const AssetPack& pack) {
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < pack.file.size; i += 4096)
+        sink = sink + pack.file.data[i];
+}
+
+const PackEntry* findEntry(const AssetPack& pack, const char* name, uint32_t kind) {
+    for (int i = 0; i < pack.entryCount; i++) {
+        if (pack.entries[i].kind == kind && strcmp(pack.entries[i].name, name) == 0) return &pack.entries[i];
+    }
+    return nullptr;
+}
+
+void addPackEntry(PackBuilder& builder, const char* name, uint32_t kind, const void* bytes, size_t size,
+                  uint32_t format, int width, int height, int pitch) {
+    PackEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    strncpy(entry.name, name, sizeof(entry.name) - 1);
+    entry.kind = kind;
+    entry.size = size;
+    entry.format = format;
+    entry.width = width;
+    entry.height = height;
+    entry.pitch = pitch;
+    builder.entries.push_back(entry);
+    const unsigned char* begin = (const unsigned char*)bytes;
+    builder.blobs.emplace_back(begin, begin + size);
+}
+
+bool savePack(const PackBuilder& builder, const char* path) {
+    PackHeader header;
+    memcpy(header.magic, PACK_MAGIC, 4);
+    header.version = PACK_VERSION;
+    header.entryCount = builder.entries.size();
+    header.reserved = 0;
+
+    // Đặt offset cho từng mục sau bảng mục, căn 16 byte
+    std::vector<PackEntry> entries = builder.entries;
+    size_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (PackEntry& entry : entries) {
+        offset = (offset + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+        entry.offset = offset;
+        offset += entry.size;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (!entries.empty())
+        ok = ok && fwrite(entries.data(), sizeof(PackEntry), entries.size(), file) == entries.size();
+    size_t written = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    const unsigned char zeros[PACK_ALIGN] = {};
+    for (size_t i = 0; i < entries.size() && ok; i++) {
+        ok = fwrite(zeros, 1, entries[i].offset - written, file) == entries[i].offset - written;
+        ok = ok && fwrite(builder.blobs[i].data(), 1, entries[i].size, file) == entries[i].size;
+        written = entries[i].offset + entries[i].size;
+    }
+    return fclose(file) == 0 && ok;
+}
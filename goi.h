@@ -0,0 +1,96 @@
+#pragma once
+// Gói tài nguyên: mọi ảnh (đã giải mã, thu về cỡ vẽ và xếp sẵn thành tập ảnh, xem
+// tapanh.h) và âm thanh (PCM đúng định dạng mở Mix_OpenAudio) trong một file, tạo bởi
+// công cụ donggoi. Lúc chạy file được ánh xạ vào bộ nhớ (mmap / MapViewOfFile) và dữ
+// liệu được dùng thẳng từ vùng nhớ đó, không đọc hay giải mã PNG/WAV nữa.
+//
+// Cấu trúc file (little-endian, cùng kiểu máy với máy chạy game): PackHeader, rồi
+// entryCount PackEntry, rồi dữ liệu các mục, mỗi mục bắt đầu ở offset chia hết cho 16.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const uint32_t PACK_VERSION = 1;
+
+// Định dạng âm thanh trong gói: 44100 Hz, 16 bit, 2 kênh như Mix_OpenAudio của testamthah2
+const int PACK_AUDIO_FREQUENCY = 44100;
+const int PACK_AUDIO_CHANNELS = 2;
+
+enum PackKind {
+    PACK_IMAGE,   // Điểm ảnh, dùng thẳng cho SDL_UpdateTexture
+    PACK_SOUND,   // PCM, dùng thẳng cho Mix_QuickLoad_RAW
+    PACK_SPRITES  // Bảng vùng của tập ảnh, mảng PackSprite
+};
+
+struct PackHeader {
+    char magic[4];       // "BCAP"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry {
+    char name[32];       // Kết thúc bằng '\0'
+    uint32_t kind;       // PackKind
+    uint32_t offset;     // Tính từ đầu file
+    uint32_t size;       // Số byte
+    uint32_t format;     // Ảnh: SDL_PIXELFORMAT_*; âm thanh: SDL_AudioFormat
+    int32_t width;       // Ảnh: pixel; âm thanh: tần số (Hz)
+    int32_t height;      // Ảnh: pixel; âm thanh: số kênh
+    int32_t pitch;       // Ảnh: số byte mỗi hàng
+    int32_t reserved;
+};
+
+// Một vùng của tập ảnh trong mục PACK_SPRITES (tương ứng AtlasSprite)
+struct PackSprite {
+    char name[32];
+    int32_t x, y, w, h;
+    int32_t turned[4];
+};
+
+// Một file ánh xạ chỉ đọc vào bộ nhớ (mmap / MapViewOfFile)
+struct MappedFile {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    void* mapping = nullptr; // Handle ánh xạ của Windows
+};
+
+// Ánh xạ cả file; trang nào chưa dùng tới thì chưa phải đọc từ đĩa. false nếu không mở
+// được hoặc file rỗng
+bool mapFile(MappedFile& file, const char* path);
+void unmapFile(MappedFile& file);
+
+// Trả cho hệ điều hành các trang nằm trọn trong [offset, offset + size) đã đọc xong, để
+// chúng không còn tính vào bộ nhớ của tiến trình; đọc lại thì hệ điều hành nạp lại từ file
+void releasePages(const MappedFile& file, size_t offset, size_t size);
+
+// Gói đang mở; entries và dữ liệu các mục trỏ thẳng vào vùng nhớ ánh xạ
+struct AssetPack {
+    MappedFile file;
+    const PackEntry* entries = nullptr;
+    int entryCount = 0;
+};
+
+// Ánh xạ file path vào bộ nhớ; false nếu không có file hoặc file không phải gói hợp lệ
+bool openPack(AssetPack& pack, const char* path);
+void closePack(AssetPack& pack);
+
+// Đọc trước mọi trang của gói (nên gọi ở luồng nền) để lúc dùng dữ liệu không phải chờ đĩa
+void touchPack(const AssetPack& pack);
+
+// Mục có tên name và loại kind, nullptr nếu không có
+const PackEntry* findEntry(const AssetPack& pack, const char* name, uint32_t kind);
+
+inline const void* entryData(const AssetPack& pack, const PackEntry& entry) {
+    return pack.file.data + entry.offset;
+}
+
+// Gói đang tạo trong bộ nhớ (công cụ donggoi), ghi ra file bằng savePack
+struct PackBuilder {
+    std::vector<PackEntry> entries;
+    std::vector<std::vector<unsigned char>> blobs;
+};
+
+void addPackEntry(PackBuilder& builder, const char* name, uint32_t kind, const void* bytes, size_t size,
+                  uint32_t format, int width, int height, int pitch);
+bool savePack(const PackBuilder& builder, const char* path);
@@ -0,0 +1,67 @@
+#include "hieunang.h"
+#include <algorithm>
+#include <cstdio>
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "input", "moveEnemies", "enemyShoot", "updateBullets", "render", "present",
+};
+
+void copyProfileSamples(const Profiler& profiler, std::vector<ProfileSample>& out) {
+    uint64_t end = profiler.written.load(std::memory_order_acquire);
+    uint64_t begin = end > (uint64_t)PROFILE_CAPACITY ? end - PROFILE_CAPACITY : 0;
+    out.clear();
+    for (uint64_t i = begin; i < end; i++) {
+        const ProfileSlot& slot = profiler.samples[i & (PROFILE_CAPACITY - 1)];
+        out.push_back({slot.start.load(std::memory_order_relaxed), slot.duration.load(std::memory_order_relaxed),
+                       slot.phase.load(std::memory_order_relaxed)});
+    }
+    // Luồng ghi có thể đã đè lên đầu vòng trong lúc chép. Mẫu thứ after có thể đang được
+    // ghi dở vào ô của mẫu after - PROFILE_CAPACITY, nên bỏ thêm cả ô đó. Rào acquire ghép
+    // với rào release trong addProfileSample: đã đọc phải trường của mẫu nào thì lần đọc
+    // written dưới đây cũng thấy mẫu đó
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = profiler.written.load(std::memory_order_acquire) + 1;
+    uint64_t overwritten = after > begin + PROFILE_CAPACITY ? after - begin - PROFILE_CAPACITY : 0;
+    out.erase(out.begin(), out.begin() + std::min<uint64_t>(overwritten, out.size()));
+}
+
+// Giá trị ở vị trí fraction của dãy đã sắp xếp
+static double percentile(const std::vector<int64_t>& sorted, double fraction) {
+    size_t index = std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()));
+    return sorted[index] / 1e6;
+}
+
+void computePhaseStats(const std::vector<ProfileSample>& samples, int64_t since, PhaseStats stats[PHASE_COUNT]) {
+    std::vector<int64_t> durations[PHASE_COUNT];
+    for (const ProfileSample& sample : samples) {
+        if (sample.start >= since && sample.phase >= 0 && sample.phase < PHASE_COUNT)
+            durations[sample.phase].push_back(sample.duration);
+    }
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        std::vector<int64_t>& sorted = durations[phase];
+        PhaseStats& result = stats[phase];
+        result = {(int)sorted.size(), 0, 0, 0, 0, 0};
+        if (sorted.empty()) continue;
+        std::sort(sorted.begin(), sorted.end());
+        result.p50 = percentile(sorted, 0.50);
+        result.p95 = percentile(sorted, 0.95);
+        result.p99 = percentile(sorted, 0.99);
+        result.max = sorted.back() / 1e6;
+        for (int64_t duration : sorted)
+            result.total += duration / 1e6;
+    }
+}
+
+bool writeChromeTrace(const std::vector<ProfileSample>& samples, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (size_t i = 0; i < samples.size(); i++) {
+        const ProfileSample& sample = samples[i];
+        // Đơn vị thời gian của trace là micro giây
+        fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                i > 0 ? "," : "", PHASE_NAMES[sample.phase], sample.start / 1e3, sample.duration / 1e3);
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
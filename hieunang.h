@@ -0,0 +1,96 @@
+#pragma once
+// Đo thời gian từng phần của vòng lặp game (đọc phím, moveEnemies, enemyShoot,
+// updateBullets, render, SDL_RenderPresent). Mỗi phần đặt một ProfileScope; mẫu đo ghi vào
+// vòng PROFILE_CAPACITY mẫu của một Profiler, mẫu mới đè mẫu cũ nhất. Mỗi Profiler chỉ một
+// luồng ghi và không khóa: luồng khác đọc bằng copyProfileSamples. Lõi mô phỏng đo qua
+// World::profiler, nên các trận chạy song song (chaynhieutran) không ghi chung một vòng.
+// Tắt (enabled = false) thì mỗi phần chỉ tốn một phép so sánh; bật thì thêm hai lần đọc
+// steady_clock (vài chục ns) mỗi phần, rất nhỏ so với một tick 16 ms nên để bật cả khi chơi.
+// Phần không cần SDL nằm hết trong file này để lõi mô phỏng dùng được mà không phải link
+// thêm; thống kê và ghi file trace ở hieunang.cpp.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+enum ProfilePhase {
+    PHASE_INPUT,          // SDL_PollEvent và handleInput
+    PHASE_MOVE_ENEMIES,
+    PHASE_ENEMY_SHOOT,
+    PHASE_UPDATE_BULLETS,
+    PHASE_RENDER,         // render() trừ SDL_RenderPresent
+    PHASE_PRESENT,
+    PHASE_COUNT
+};
+
+extern const char* const PHASE_NAMES[PHASE_COUNT];
+
+const int PROFILE_CAPACITY = 1 << 15; // Lũy thừa của 2; ~ 1 phút ở 60 tick/giây
+
+struct ProfileSample {
+    int64_t start;    // ns tính từ lúc khởi động
+    int64_t duration; // ns
+    int phase;
+};
+
+// Một ô của vòng: luồng ghi có thể đè ô trong lúc luồng khác đang chép, nên các trường là
+// atomic (đọc ghi relaxed, trên x86 giá như biến thường) thay vì ProfileSample thường
+struct ProfileSlot {
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> duration{0};
+    std::atomic<int> phase{0};
+};
+
+struct Profiler {
+    bool enabled = false;
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    ProfileSlot samples[PROFILE_CAPACITY];
+    std::atomic<uint64_t> written{0}; // Tổng số mẫu đã ghi; mẫu i nằm ở samples[i % PROFILE_CAPACITY]
+};
+
+inline int64_t profileNow(const Profiler& profiler) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profiler.origin).count();
+}
+
+inline void addProfileSample(Profiler& profiler, int phase, int64_t start, int64_t end) {
+    uint64_t index = profiler.written.load(std::memory_order_relaxed);
+    // Luồng chép thấy bất kỳ trường nào của mẫu index thì cũng thấy written >= index
+    std::atomic_thread_fence(std::memory_order_release);
+    ProfileSlot& slot = profiler.samples[index & (PROFILE_CAPACITY - 1)];
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.phase.store(phase, std::memory_order_relaxed);
+    profiler.written.store(index + 1, std::memory_order_release);
+}
+
+// Đo từ lúc tạo tới lúc hủy (hoặc tới stop()); profiler null hoặc đang tắt thì không đo
+struct ProfileScope {
+    Profiler* profiler;
+    int phase;
+    int64_t start;
+
+    ProfileScope(Profiler* profiler, int phase)
+        : profiler(profiler), phase(phase), start(profiler && profiler->enabled ? profileNow(*profiler) : -1) {}
+    ~ProfileScope() { stop(); }
+
+    void stop() {
+        if (start >= 0) addProfileSample(*profiler, phase, start, profileNow(*profiler));
+        start = -1;
+    }
+};
+
+// Chép các mẫu còn trong vòng (cũ tới mới); bỏ các mẫu bị ghi đè, kể cả mẫu luồng ghi
+// có thể đang ghi dở, trong lúc đang chép
+void copyProfileSamples(const Profiler& profiler, std::vector<ProfileSample>& out);
+
+// Thống kê một phần (ms) trên các mẫu bắt đầu từ since (ns) trở đi
+struct PhaseStats {
+    int count;
+    double p50, p95, p99, max;
+    double total;
+};
+void computePhaseStats(const std::vector<ProfileSample>& samples, int64_t since, PhaseStats stats[PHASE_COUNT]);
+
+// Ghi các mẫu ra file JSON theo định dạng trace của Chrome (mở bằng chrome://tracing hoặc
+// ui.perfetto.dev), mỗi mẫu một sự kiện "X"
+bool writeChromeTrace(const std::vector<ProfileSample>& samples, const char* path);
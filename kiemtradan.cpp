@@ -0,0 +1,147 @@
+// Kiểm tra va chạm quét của đạn (sweepRect / updateBullets): đạn nhỏ và đạn lớn không
+// được xuyên qua chướng ngại vật một ô hay xe tăng khi tick dài 16 / 50 / 100 ms, kể cả
+// đạn rất nhanh đi xa hơn cả bản đồ nhìn thấy trong một tick; đạn sượt đúng mép không
+// tính là trúng; đạn đã chồng lên vật ngay từ đầu thì trúng ở lượt đầu tiên; cùng một
+// khoảng thời gian thì đạn đi đúng một quãng đường dù tick dài hay ngắn (kể cả 1 ms).
+// In từng trường hợp và trả về 1 nếu có trường hợp sai.
+// Biên dịch: g++ -O2 kiemtradan.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp -o kiemtradan
+#include "mophong.h"
+#include <cstdio>
+
+const int MAP_COLS = 30;
+const int MAP_ROWS = 5;
+const int LANE = 2;       // Hàng đạn bay qua, không có gì ngoài vật được đặt
+const int TARGET_COL = 10;
+const int FAST_SPEED = 2 * CELL_SIZE; // px mỗi TICK_MS: 100 ms tick đi ~875 px, qua hơn 12 ô
+const int TRAVEL_MS = 800;           // Thời gian bay của phép thử quãng đường, chia hết cho mọi độ dài tick thử
+
+int failures = 0;
+int cases = 0;
+
+void check(bool ok, const char* name, int tickMs, bool large, int speed) {
+    cases++;
+    if (!ok) failures++;
+    printf("%-4s %-22s tick %3d ms  dan %-3s  toc do %3d\n", ok ? "ok" : "SAI", name, tickMs,
+           large ? "lon" : "nho", speed);
+}
+
+// Bản đồ MAP_COLS x MAP_ROWS không có chướng ngại vật và xe địch; người chơi ở góc trái dưới
+void emptyWorld(World& world, int tickMs) {
+    initWorld(world, MAP_COLS, MAP_ROWS, 0, 1);
+    for (int cy = 0; cy < MAP_ROWS; cy++) {
+        for (int cx = 0; cx < MAP_COLS; cx++)
+            clearCell(world.obstacleBits, cellIndex(world, cx, cy));
+    }
+    world.tickMs = tickMs;
+}
+
+// Đạn có tâm ở tâm ô (cx, cy) bay theo (dx, dy) px mỗi TICK_MS
+Bullet makeBullet(int cx, int cy, int dx, int dy, bool large, bool isEnemy) {
+    int size = large ? BULLET_SIZE_LARGE : BULLET_SIZE_SMALL;
+    Bullet bullet;
+    bullet.rect = {cx * CELL_SIZE + CELL_SIZE / 2 - size / 2, cy * CELL_SIZE + CELL_SIZE / 2 - size / 2, size, size};
+    bullet.dx = dx;
+    bullet.dy = dy;
+    bullet.large = large;
+    bullet.isEnemy = isEnemy;
+    return bullet;
+}
+
+// Chạy updateBullets tới khi hết đạn (hoặc quá nhiều tick); trả về số tick đã chạy
+int runUntilGone(World& world) {
+    int ticks = 0;
+    while (world.bullets.count > 0 && ticks < 10000) {
+        updateBullets(world);
+        ticks++;
+    }
+    return ticks;
+}
+
+void testObstacle(int tickMs, bool large, int speed) {
+    World world;
+    emptyWorld(world, tickMs);
+    int target = cellIndex(world, TARGET_COL, LANE);
+    setCell(world.obstacleBits, target);
+    addBullet(world.bullets, makeBullet(0, LANE, speed, 0, large, false));
+    runUntilGone(world);
+    check(!testCell(world.obstacleBits, target), "chuong ngai vat", tickMs, large, speed);
+}
+
+void testEnemy(int tickMs, bool large, int speed) {
+    World world;
+    emptyWorld(world, tickMs);
+    spawnEnemy(world, TARGET_COL, LANE);
+    addBullet(world.bullets, makeBullet(0, LANE, speed, 0, large, false));
+    runUntilGone(world);
+    check(world.enemies.count == 0, "xe dich", tickMs, large, speed);
+}
+
+// Đạn xe địch bay từ phải sang trái dọc hàng của người chơi
+void testPlayer(int tickMs, bool large, int speed) {
+    World world;
+    emptyWorld(world, tickMs);
+    addBullet(world.bullets, makeBullet(MAP_COLS - 1, MAP_ROWS - 1, -speed, 0, large, true));
+    runUntilGone(world);
+    check(!world.playerAlive, "nguoi choi", tickMs, large, speed);
+}
+
+// Đạn bay sát mép trên của chướng ngại vật (mép dưới đạn = mép trên ô): không trúng,
+// bay tới hết bản đồ
+void testGrazing(int tickMs, bool large, int speed) {
+    World world;
+    emptyWorld(world, tickMs);
+    int target = cellIndex(world, TARGET_COL, LANE + 1);
+    setCell(world.obstacleBits, target);
+    Bullet bullet = makeBullet(0, LANE, speed, 0, large, false);
+    bullet.rect.y = (LANE + 1) * CELL_SIZE - bullet.rect.h;
+    addBullet(world.bullets, bullet);
+    runUntilGone(world);
+    check(testCell(world.obstacleBits, target) && world.bullets.count == 0, "sat mep", tickMs, large, speed);
+}
+
+// Đạn bắt đầu đã chồng lên chướng ngại vật: trúng ngay lượt đầu
+void testOverlapping(int tickMs, bool large, int speed) {
+    World world;
+    emptyWorld(world, tickMs);
+    int target = cellIndex(world, TARGET_COL, LANE);
+    setCell(world.obstacleBits, target);
+    addBullet(world.bullets, makeBullet(TARGET_COL, LANE, speed, 0, large, false));
+    updateBullets(world);
+    check(!testCell(world.obstacleBits, target) && world.bullets.count == 0, "chong san", tickMs, large, speed);
+}
+
+// Đạn bay tự do TRAVEL_MS ms: quãng đường phải đúng speed * TRAVEL_MS / TICK_MS px với mọi
+// độ dài tick, không hụt dần vì phần lẻ bị cắt ở mỗi tick
+void testDistance(int tickMs, bool large, int speed) {
+    World world;
+    emptyWorld(world, tickMs);
+    Bullet bullet = makeBullet(0, LANE, speed, 0, large, false);
+    addBullet(world.bullets, bullet);
+    for (int t = 0; t < TRAVEL_MS / tickMs; t++)
+        updateBullets(world);
+    int travelled = world.bullets.count == 1 ? world.bullets.x[0] - bullet.rect.x : -1;
+    check(travelled == speed * TRAVEL_MS / TICK_MS, "quang duong", tickMs, large, speed);
+}
+
+int main() {
+    const int tickLengths[] = {16, 50, 100};
+    for (int tickMs : tickLengths) {
+        for (int large = 0; large < 2; large++) {
+            int speeds[] = {large ? BULLET_SPEED_LARGE : BULLET_SPEED_SMALL, FAST_SPEED};
+            for (int speed : speeds) {
+                testObstacle(tickMs, large, speed);
+                testEnemy(tickMs, large, speed);
+                testPlayer(tickMs, large, speed);
+                testGrazing(tickMs, large, speed);
+                testOverlapping(tickMs, large, speed);
+            }
+        }
+    }
+    const int shortTicks[] = {1, 10, 16, 50, 100};
+    for (int tickMs : shortTicks) {
+        testDistance(tickMs, false, BULLET_SPEED_SMALL);
+        testDistance(tickMs, true, BULLET_SPEED_LARGE);
+    }
+    printf("%d/%d truong hop dung\n", cases - failures, cases);
+    return failures > 0 ? 1 : 0;
+}
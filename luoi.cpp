@@ -0,0 +1,99 @@
+#include "luoi.h"
+#include "mophong.h"
+#include <algorithm>
+
+void initGrid(SpatialGrid& grid, int cols, int rows) {
+    grid.cols = cols;
+    grid.rows = rows;
+    grid.chunkCols = chunksFor(cols);
+    grid.chunkRows = chunksFor(rows);
+    grid.chunkOffset.assign(grid.chunkCols * grid.chunkRows, -1);
+    grid.cellHead.clear();
+    grid.nextInCell.clear();
+    grid.entityCell.clear();
+}
+
+int cellAt(const SpatialGrid& grid, int px, int py) {
+    if (px < 0 || py < 0) return -1;
+    int cx = px / CELL_SIZE;
+    int cy = py / CELL_SIZE;
+    if (cx >= grid.cols || cy >= grid.rows) return -1;
+    return tiledCell(grid.chunkCols, cx, cy);
+}
+
+void gridInsert(SpatialGrid& grid, int entity, int cell) {
+    if (entity >= (int)grid.entityCell.size()) {
+        grid.nextInCell.resize(entity + 1, -1);
+        grid.entityCell.resize(entity + 1, -1);
+    }
+    // Khối được cấp phát khi lần đầu có thực thể, và giữ lại đến khi initGrid.
+    // Khối ở mép dưới bản đồ chỉ cấp phát các hàng nằm trong bản đồ.
+    int chunk = cell >> CHUNK_CELL_SHIFT;
+    if (grid.chunkOffset[chunk] < 0) {
+        int rowsInChunk = std::min(CHUNK_SIZE, grid.rows - (chunk / grid.chunkCols) * CHUNK_SIZE);
+        grid.chunkOffset[chunk] = grid.cellHead.size();
+        grid.cellHead.resize(grid.cellHead.size() + rowsInChunk * CHUNK_SIZE, -1);
+    }
+    int& head = grid.cellHead[grid.chunkOffset[chunk] + (cell & (CHUNK_CELLS - 1))];
+    grid.entityCell[entity] = cell;
+    grid.nextInCell[entity] = head;
+    head = entity;
+}
+
+void gridRemove(SpatialGrid& grid, int entity) {
+    int cell = grid.entityCell[entity];
+    if (cell < 0) return;
+    // Danh sách trong một ô rất ngắn nên tìm tuyến tính là đủ
+    int* link = &grid.cellHead[grid.chunkOffset[cell >> CHUNK_CELL_SHIFT] + (cell & (CHUNK_CELLS - 1))];
+    while (*link != entity)
+        link = &grid.nextInCell[*link];
+    *link = grid.nextInCell[entity];
+    grid.nextInCell[entity] = -1;
+    grid.entityCell[entity] = -1;
+}
+
+void gridMove(SpatialGrid& grid, int entity, int cell) {
+    if (grid.entityCell[entity] == cell) return;
+    gridRemove(grid, entity);
+    gridInsert(grid, entity, cell);
+}
+
+void initBitGrid(BitGrid& grid, int cols, int rows) {
+    grid.cols = cols;
+    grid.rows = rows;
+    grid.chunkCols = chunksFor(cols);
+    grid.chunkRows = chunksFor(rows);
+    grid.chunkOffset.assign(grid.chunkCols * grid.chunkRows, -1);
+    grid.words.clear();
+}
+
+int allocateChunk(BitGrid& grid, int chunk) {
+    int offset = grid.words.size();
+    grid.words.resize(offset + CHUNK_SIZE, 0);
+    grid.chunkOffset[chunk] = offset;
+    return offset;
+}
+
+int countCells(const BitGrid& grid) {
+    int count = 0;
+    for (unsigned long long word : grid.words)
+        count += __builtin_popcountll(word);
+    return count;
+}
+
+int nextSetCell(const BitGrid& grid, int start) {
+    int chunkCount = grid.chunkOffset.size();
+    int chunk = start >> CHUNK_CELL_SHIFT;
+    int row = (start >> CHUNK_SHIFT) & (CHUNK_SIZE - 1);
+    unsigned long long mask = ~0ULL << (start & 63);
+    for (; chunk < chunkCount; chunk++, row = 0, mask = ~0ULL) {
+        int offset = grid.chunkOffset[chunk];
+        if (offset < 0) continue;
+        for (; row < CHUNK_SIZE; row++, mask = ~0ULL) {
+            unsigned long long word = grid.words[offset + row] & mask;
+            if (word != 0)
+                return (chunk << CHUNK_CELL_SHIFT) | (row << CHUNK_SHIFT) | __builtin_ctzll(word);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,109 @@
+#pragma once
+// Chỉ mục không gian theo ô lưới CELL_SIZE: mỗi thực thể đăng ký vào ô nó
+// đang đứng, nên truy vấn va chạm chỉ cần xét vài ô thay vì mọi thực thể.
+// Danh sách trong mỗi ô là danh sách liên kết nội bộ, cấp phát khi số thực thể
+// tăng lên (lúc dựng bản đồ). Di chuyển trong các khối đã có thì không cấp phát;
+// lần đầu một thực thể đi vào khối chưa từng có dữ liệu thì cấp phát khối đó một
+// lần (xem dưới), nên trên bản đồ lớn vẫn có thể cấp phát trong lúc chơi.
+#include <vector>
+
+// Bản đồ được chia thành các khối CHUNK_SIZE x CHUNK_SIZE ô. Chỉ số ô được đánh
+// theo khối: các ô của một khối nằm liền nhau, hàng trong khối nối tiếp hàng.
+// Dữ liệu của một khối chỉ được cấp phát khi khối lần đầu có dữ liệu (gridInsert,
+// gridMove, setCell) và giữ lại tới lần init sau, nên bản đồ hàng nghìn x hàng nghìn
+// ô chỉ tốn bộ nhớ cho các khối có dữ liệu, và mỗi khối cấp phát nhiều nhất một lần.
+// CHUNK_SIZE phải là 64: mỗi hàng của khối là đúng một từ trong BitGrid.
+const int CHUNK_SHIFT = 6;
+const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+const int CHUNK_CELL_SHIFT = 2 * CHUNK_SHIFT;
+const int CHUNK_CELLS = 1 << CHUNK_CELL_SHIFT;
+
+// Số khối cần cho cells ô theo một chiều
+inline int chunksFor(int cells) {
+    return (cells + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+}
+
+// Chỉ số của ô (cx, cy) trên bản đồ rộng chunkCols khối
+inline int tiledCell(int chunkCols, int cx, int cy) {
+    int chunk = (cy >> CHUNK_SHIFT) * chunkCols + (cx >> CHUNK_SHIFT);
+    return (chunk << CHUNK_CELL_SHIFT) | ((cy & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) | (cx & (CHUNK_SIZE - 1));
+}
+
+// Cột và hàng của một chỉ số ô (có phép chia, không dùng trong vòng lặp nóng)
+inline int tiledCellX(int chunkCols, int cell) {
+    return (((cell >> CHUNK_CELL_SHIFT) % chunkCols) << CHUNK_SHIFT) | (cell & (CHUNK_SIZE - 1));
+}
+
+inline int tiledCellY(int chunkCols, int cell) {
+    return (((cell >> CHUNK_CELL_SHIFT) / chunkCols) << CHUNK_SHIFT) | ((cell >> CHUNK_SHIFT) & (CHUNK_SIZE - 1));
+}
+
+struct SpatialGrid {
+    int cols, rows;
+    int chunkCols, chunkRows;
+    std::vector<int> chunkOffset; // Vị trí khối trong cellHead, -1 nếu khối chưa từng có thực thể
+    std::vector<int> cellHead;    // CHUNK_CELLS đầu danh sách cho mỗi khối đã cấp phát, -1 nếu ô trống
+    std::vector<int> nextInCell;  // Thực thể kế tiếp trong cùng ô, -1 nếu hết
+    std::vector<int> entityCell;  // Ô hiện tại của thực thể, -1 nếu chưa đăng ký
+};
+
+void initGrid(SpatialGrid& grid, int cols, int rows);
+
+// Chỉ số ô chứa điểm (px, py), -1 nếu nằm ngoài bản đồ
+int cellAt(const SpatialGrid& grid, int px, int py);
+
+void gridInsert(SpatialGrid& grid, int entity, int cell);
+void gridRemove(SpatialGrid& grid, int entity);
+void gridMove(SpatialGrid& grid, int entity, int cell);
+
+// Thực thể đầu tiên trong ô, -1 nếu ô trống
+inline int firstInCell(const SpatialGrid& grid, int cell) {
+    int offset = grid.chunkOffset[cell >> CHUNK_CELL_SHIFT];
+    return offset < 0 ? -1 : grid.cellHead[offset + (cell & (CHUNK_CELLS - 1))];
+}
+
+// Duyệt các thực thể trong ô: for (int e = firstInCell(grid, c); e != -1; e = grid.nextInCell[e])
+
+// Lưới bit: mỗi ô một bit, mỗi hàng của khối một từ máy. Khối 64x64 ô chỉ tốn
+// 512 byte mỗi lớp, kiểm tra hay sửa một ô là một phép toán trên một từ.
+struct BitGrid {
+    int cols, rows;
+    int chunkCols, chunkRows;
+    std::vector<int> chunkOffset;          // Vị trí khối trong words, -1 nếu khối chưa từng có bit nào
+    std::vector<unsigned long long> words; // CHUNK_SIZE từ cho mỗi khối đã cấp phát
+};
+
+void initBitGrid(BitGrid& grid, int cols, int rows);
+// Cấp phát khối chunk (toàn bit 0), trả về vị trí của nó trong words
+int allocateChunk(BitGrid& grid, int chunk);
+
+inline bool testCell(const BitGrid& grid, int cell) {
+    int offset = grid.chunkOffset[cell >> CHUNK_CELL_SHIFT];
+    if (offset < 0) return false;
+    return (grid.words[offset + ((cell >> CHUNK_SHIFT) & (CHUNK_SIZE - 1))] >> (cell & 63)) & 1;
+}
+
+inline void setCell(BitGrid& grid, int cell) {
+    int offset = grid.chunkOffset[cell >> CHUNK_CELL_SHIFT];
+    if (offset < 0) offset = allocateChunk(grid, cell >> CHUNK_CELL_SHIFT);
+    grid.words[offset + ((cell >> CHUNK_SHIFT) & (CHUNK_SIZE - 1))] |= 1ULL << (cell & 63);
+}
+
+inline void clearCell(BitGrid& grid, int cell) {
+    int offset = grid.chunkOffset[cell >> CHUNK_CELL_SHIFT];
+    if (offset < 0) return;
+    grid.words[offset + ((cell >> CHUNK_SHIFT) & (CHUNK_SIZE - 1))] &= ~(1ULL << (cell & 63));
+}
+
+// 64 ô của hàng cy trong khối cột chunkX (bit i là ô chunkX * 64 + i), 0 nếu khối trống
+inline unsigned long long rowBits(const BitGrid& grid, int chunkX, int cy) {
+    int offset = grid.chunkOffset[(cy >> CHUNK_SHIFT) * grid.chunkCols + chunkX];
+    return offset < 0 ? 0 : grid.words[offset + (cy & (CHUNK_SIZE - 1))];
+}
+
+// Số ô đang được đánh dấu
+int countCells(const BitGrid& grid);
+
+// Ô được đánh dấu tiếp theo (theo thứ tự chỉ số ô) từ ô start trở đi, -1 nếu không còn.
+// Khối chưa cấp phát được bỏ qua cả khối.
+int nextSetCell(const BitGrid& grid, int start);
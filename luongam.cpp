@@ -0,0 +1,189 @@
+#include "luongam.h"
+#include <algorithm>
+#include <cstring>
+
+static uint32_t read32(const unsigned char* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int read16(const unsigned char* p) {
+    return p[0] | p[1] << 8;
+}
+
+// Ghi lý do vào SDL_GetError() và trả về false
+template <typename... Args>
+static bool streamError(const char* format, Args... args) {
+    SDL_SetError(format, args...);
+    return false;
+}
+
+// Tìm khối "fmt " và "data" của file WAV; false nếu không phải WAV PCM SDL đổi được hoặc
+// phần đầu file mâu thuẫn
+static bool parseWav(AudioStream& stream, SDL_AudioFormat& format, int& channels, int& frequency) {
+    const unsigned char* data = stream.file.data;
+    size_t size = stream.file.size;
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0)
+        return streamError("không phải file WAV");
+
+    bool haveFormat = false;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const unsigned char* chunk = data + pos;
+        size_t length = std::min<size_t>(read32(chunk + 4), size - pos - 8);
+        if (memcmp(chunk, "fmt ", 4) == 0 && length >= 16) {
+            int tag = read16(chunk + 8);
+            if (tag == 0xFFFE) { // WAVE_FORMAT_EXTENSIBLE: định dạng thật ở đầu GUID con
+                if (length < 40) return streamError("khối fmt mở rộng quá ngắn");
+                tag = read16(chunk + 32);
+            }
+            channels = read16(chunk + 10);
+            frequency = read32(chunk + 12);
+            int blockAlign = read16(chunk + 20);
+            int bits = read16(chunk + 22);
+            if (tag == 1 && bits == 8) format = AUDIO_U8;
+            else if (tag == 1 && bits == 16) format = AUDIO_S16LSB;
+            else if (tag == 1 && bits == 32) format = AUDIO_S32LSB;
+            else if (tag == 3 && bits == 32) format = AUDIO_F32LSB;
+            else return streamError("định dạng WAV không hỗ trợ (mã %d, %d bit)", tag, bits);
+            if (channels <= 0 || frequency <= 0)
+                return streamError("số kênh hoặc tần số không hợp lệ (%d kênh, %d Hz)", channels, frequency);
+            // Khung mẫu phải đúng số kênh x số byte mỗi mẫu, không thì đọc lệch cả luồng
+            if (blockAlign != channels * bits / 8)
+                return streamError("blockAlign %d không khớp %d kênh x %d bit", blockAlign, channels, bits);
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) return streamError("khối data nằm trước khối fmt");
+            stream.dataBegin = pos + 8;
+            stream.dataEnd = pos + 8 + length;
+            stream.sourceFrameBytes = channels * SDL_AUDIO_BITSIZE(format) / 8;
+            if (stream.dataEnd - stream.dataBegin < (size_t)stream.sourceFrameBytes)
+                return streamError("khối data rỗng");
+            return true;
+        }
+        pos += 8 + length + (length & 1); // Khối có độ dài lẻ được đệm một byte
+    }
+    return streamError("không tìm thấy khối fmt và data");
+}
+
+bool openAudioStream(AudioStream& stream, const char* path, bool loop) {
+    closeAudioStream(stream);
+    int frequency = 0, channels = 0, mixerFrequency = 0, mixerChannels = 0;
+    SDL_AudioFormat format = 0;
+    if (!Mix_QuerySpec(&mixerFrequency, &stream.format, &mixerChannels))
+        return streamError("SDL_mixer chưa mở");
+    if (!mapFile(stream.file, path)) return streamError("không mở được %s", path);
+    if (!parseWav(stream, format, channels, frequency)) {
+        unmapFile(stream.file);
+        return false;
+    }
+    stream.converter = SDL_NewAudioStream(format, channels, frequency, stream.format, mixerChannels, mixerFrequency);
+    if (!stream.converter) {
+        unmapFile(stream.file);
+        return false;
+    }
+    int mixerFrameBytes = mixerChannels * SDL_AUDIO_BITSIZE(stream.format) / 8;
+    stream.blockCapacity = STREAM_BLOCK_BYTES / mixerFrameBytes * mixerFrameBytes;
+    stream.readPos = stream.releasedPos = stream.dataBegin;
+    stream.loop = loop;
+    stream.drained = false;
+    stream.filled = 0;
+    stream.consumed = 0;
+    stream.blockOffset = 0;
+    stream.finished = false;
+    stream.underruns = 0;
+    return true;
+}
+
+// Callback nhạc của SDL_mixer (luồng âm thanh): trộn các khối đã đổi định dạng vào out.
+// SDL_mixer đã xóa out về im lặng trước khi gọi.
+static void mixStream(void* userdata, Uint8* out, int length) {
+    AudioStream& stream = *(AudioStream*)userdata;
+    int volume = stream.volume.load(std::memory_order_relaxed);
+    int done = 0;
+    while (done < length) {
+        unsigned int consumed = stream.consumed.load(std::memory_order_relaxed);
+        if (consumed == stream.filled.load(std::memory_order_acquire)) {
+            if (!stream.finished.load(std::memory_order_relaxed)) stream.underruns++;
+            return;
+        }
+        int slot = consumed % STREAM_BLOCKS;
+        int count = std::min(length - done, stream.blockBytes[slot] - stream.blockOffset);
+        SDL_MixAudioFormat(out + done, stream.blocks[slot] + stream.blockOffset, stream.format, count, volume);
+        done += count;
+        stream.blockOffset += count;
+        if (stream.blockOffset == stream.blockBytes[slot]) {
+            stream.blockOffset = 0;
+            stream.consumed.store(consumed + 1, std::memory_order_release);
+        }
+    }
+}
+
+// Đưa thêm một khối của file vào converter; hết file thì quay lại đầu (lặp) hoặc flush
+static void feedConverter(AudioStream& stream) {
+    if (stream.readPos + stream.sourceFrameBytes > stream.dataEnd) {
+        releasePages(stream.file, stream.releasedPos, stream.dataEnd - stream.releasedPos);
+        if (stream.loop) {
+            stream.readPos = stream.releasedPos = stream.dataBegin;
+        } else {
+            SDL_AudioStreamFlush(stream.converter);
+            stream.drained = true;
+            return;
+        }
+    }
+    size_t count = std::min<size_t>(STREAM_BLOCK_BYTES, stream.dataEnd - stream.readPos);
+    count -= count % stream.sourceFrameBytes;
+    SDL_AudioStreamPut(stream.converter, stream.file.data + stream.readPos, count);
+    stream.readPos += count;
+    if (stream.readPos - stream.releasedPos >= STREAM_RELEASE_BYTES) {
+        releasePages(stream.file, stream.releasedPos, stream.readPos - stream.releasedPos);
+        stream.releasedPos = stream.readPos;
+    }
+}
+
+// Đổ đầy các khối trống của vòng; chỉ luồng nạp gọi (trừ lần đầu, trước khi luồng nạp chạy)
+static void pumpAudioStream(AudioStream& stream) {
+    if (!stream.converter || stream.finished) return;
+    unsigned int filled = stream.filled.load(std::memory_order_relaxed);
+    while (filled - stream.consumed.load(std::memory_order_acquire) < (unsigned int)STREAM_BLOCKS) {
+        while (!stream.drained && SDL_AudioStreamAvailable(stream.converter) < stream.blockCapacity)
+            feedConverter(stream);
+        int slot = filled % STREAM_BLOCKS;
+        int count = SDL_AudioStreamGet(stream.converter, stream.blocks[slot], stream.blockCapacity);
+        if (count <= 0) {
+            stream.finished = stream.drained || count < 0;
+            return;
+        }
+        stream.blockBytes[slot] = count;
+        filled++;
+        stream.filled.store(filled, std::memory_order_release);
+    }
+}
+
+// Luồng nạp: giữ vòng khối đầy tới khi closeAudioStream dừng nó hoặc file không lặp đã đọc hết
+static void feedLoop(AudioStream* stream) {
+    while (stream->feeding.load(std::memory_order_relaxed) && !stream->finished) {
+        pumpAudioStream(*stream);
+        SDL_Delay(STREAM_FEED_MS);
+    }
+}
+
+void playAudioStream(AudioStream& stream) {
+    if (!stream.converter || stream.feeding) return;
+    pumpAudioStream(stream); // Có sẵn dữ liệu cho lần gọi callback đầu tiên
+    Mix_HookMusic(mixStream, &stream);
+    stream.feeding = true;
+    stream.feeder = std::thread(feedLoop, &stream);
+}
+
+bool audioStreamDone(const AudioStream& stream) {
+    return stream.finished && stream.consumed.load() == stream.filled.load();
+}
+
+void closeAudioStream(AudioStream& stream) {
+    if (Mix_GetMusicHookData() == &stream) Mix_HookMusic(nullptr, nullptr);
+    stream.feeding = false;
+    if (stream.feeder.joinable()) stream.feeder.join();
+    SDL_FreeAudioStream(stream.converter);
+    stream.converter = nullptr;
+    unmapFile(stream.file);
+}
@@ -0,0 +1,61 @@
+#pragma once
+// Phát một file WAV dài (nhạc nền) theo luồng: file được ánh xạ vào bộ nhớ (goi.h), một
+// luồng nạp riêng cứ STREAM_FEED_MS lại đổi vài khối PCM kế tiếp sang định dạng Mix_OpenAudio
+// và bỏ vào vòng STREAM_BLOCKS khối; callback nhạc của SDL_mixer (luồng âm thanh) lấy ra trộn.
+// Luồng nạp không phụ thuộc vòng lặp game, nên khung hình chậm hay SDL_Delay dài ở luồng
+// chính không làm vòng khối cạn; chỉ khi luồng nạp bị dừng lâu hơn thời lượng của vòng
+// (~190 ms) mới bị ngắt tiếng. Không giải
+// mã cả file lúc nạp, và các trang file đã phát được trả lại hệ điều hành, nên bộ nhớ
+// dùng chỉ cỡ vòng khối cộng một cửa sổ nhỏ của file, dù bài dài bao nhiêu.
+// SDL_mixer chỉ có một callback nhạc nên mỗi lúc chỉ phát được một luồng.
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <atomic>
+#include <thread>
+#include "goi.h"
+
+const int STREAM_BLOCK_BYTES = 4096;
+const int STREAM_BLOCKS = 8;               // ~190 ms ở 44100 Hz, 16 bit, 2 kênh
+const size_t STREAM_RELEASE_BYTES = 32768; // Đọc qua chừng này byte của file thì trả trang cũ
+const int STREAM_FEED_MS = 20;             // Chu kỳ đổ khối của luồng nạp, nhỏ hơn nhiều thời lượng vòng
+
+struct AudioStream {
+    MappedFile file;
+    size_t dataBegin = 0, dataEnd = 0; // Vùng PCM trong file
+    size_t readPos = 0;                // Byte kế tiếp của file sẽ đổi định dạng
+    size_t releasedPos = 0;            // Các trang trước vị trí này đã trả hệ điều hành
+    int sourceFrameBytes = 0;
+    bool loop = false;
+    bool drained = false;              // Đã đọc hết file (không lặp), chỉ còn phần trong converter
+    SDL_AudioStream* converter = nullptr;
+    SDL_AudioFormat format = AUDIO_S16SYS; // Định dạng của SDL_mixer
+    int blockCapacity = 0;             // STREAM_BLOCK_BYTES làm tròn xuống bội số khung của SDL_mixer
+
+    // Vòng khối: luồng nạp ghi (filled), luồng âm thanh đọc (consumed)
+    unsigned char blocks[STREAM_BLOCKS][STREAM_BLOCK_BYTES];
+    int blockBytes[STREAM_BLOCKS];
+    std::atomic<unsigned int> filled{0};
+    std::atomic<unsigned int> consumed{0};
+    int blockOffset = 0;               // Số byte đã lấy của khối đang phát (luồng âm thanh)
+    std::atomic<bool> finished{false}; // Không còn khối nào sẽ được ghi thêm
+    std::atomic<int> volume{MIX_MAX_VOLUME};
+    std::atomic<int> underruns{0};     // Số lần callback cần dữ liệu mà vòng khối trống
+
+    std::thread feeder;                // Luồng nạp, chạy từ playAudioStream tới closeAudioStream
+    std::atomic<bool> feeding{false};
+};
+
+// Ánh xạ file WAV PCM (8/16/32 bit nguyên hoặc 32 bit thực) và chuẩn bị đổi sang định dạng
+// SDL_mixer đang mở; chưa đọc dữ liệu. false nếu không có file, định dạng không hỗ trợ hoặc
+// phần đầu WAV mâu thuẫn (blockAlign khác số kênh x số bit); lý do lấy bằng SDL_GetError()
+bool openAudioStream(AudioStream& stream, const char* path, bool loop);
+
+// Bắt đầu phát bằng callback nhạc của SDL_mixer và chạy luồng nạp; luồng gọi không phải
+// làm gì thêm mỗi tick
+void playAudioStream(AudioStream& stream);
+
+// Phát xong (file không lặp và đã trộn hết)
+bool audioStreamDone(const AudioStream& stream);
+
+// Dừng callback nhạc (nếu đang phát luồng này), chờ luồng nạp dừng và giải phóng
+void closeAudioStream(AudioStream& stream);
@@ -0,0 +1,570 @@
+#include "mophong.h"
+#include "hieunang.h" // Đo thời gian từng phần của updateWorld (chỉ khi world.profiler bật)
+#include <algorithm>
+
+// Chỉ số ô chứa điểm (px, py) nằm trong bản đồ
+static int cellOf(const World& world, int px, int py) {
+    return cellIndex(world, px / CELL_SIZE, py / CELL_SIZE);
+}
+
+static void setEnemyCell(World& world, int cell) {
+    // Nhiều xe địch có thể đứng chung ô, nên bit chỉ tắt khi ô không còn xe nào
+    if (firstInCell(world.enemyGrid, cell) != -1) setCell(world.enemyBits, cell);
+    else clearCell(world.enemyBits, cell);
+}
+
+EnemyHandle spawnEnemy(World& world, int cx, int cy) {
+    EnemyHandle handle = addEnemyEntity(world.enemies, cx * CELL_SIZE, cy * CELL_SIZE, 0.0);
+    int i = world.enemies.index[handle.slot];
+    world.enemies.nextMove[i] = world.timeMs + MOVE_DELAY - staggerPhase(handle.slot, MOVE_DELAY);
+    world.enemies.nextShoot[i] = world.timeMs + ENEMY_SHOOT_DELAY - staggerPhase(handle.slot, ENEMY_SHOOT_DELAY);
+    gridInsert(world.enemyGrid, handle.slot, cellIndex(world, cx, cy));
+    setCell(world.enemyBits, cellIndex(world, cx, cy));
+    world.changes++;
+    return handle;
+}
+
+// Xe địch trong enemyGrid được đánh số theo ô handle (không đổi khi xe dời chỗ trong kho)
+static void killEnemy(World& world, int slot) {
+    int cell = world.enemyGrid.entityCell[slot];
+    gridRemove(world.enemyGrid, slot);
+    removeEnemyAt(world.enemies, world.enemies.index[slot]);
+    setEnemyCell(world, cell);
+    world.changes++;
+}
+
+static void killPlayer(World& world) {
+    if (world.tank.w > 0)
+        clearCell(world.playerBits, cellOf(world, world.tank.x, world.tank.y));
+    world.playerAlive = false;
+    world.tank.w = world.tank.h = 0;
+    world.changes++;
+}
+
+int bulletCapacityFor(int cols, int rows, int enemyCount) {
+    long long span = (long long)std::max(cols, rows) * CELL_SIZE;
+    long long enemyLifeMs = span * TICK_MS / BULLET_SPEED_SMALL + TICK_MS;
+    long long perEnemy = enemyLifeMs / ENEMY_SHOOT_DELAY + 1;
+    long long player = 2 * (span / BULLET_SPEED_LARGE + 1);
+    long long capacity = (long long)enemyCount * perEnemy + player;
+    return (int)std::min<long long>(std::max<long long>(capacity, MAX_BULLETS), 1 << 22);
+}
+
+// Nới kho đạn cho số xe địch hiện có; kho lớn hơn từ trước (hoặc do người gọi
+// cấp sẵn) được giữ lại nên initWorld lặp lại giữa các trận không cấp phát lại
+static void reserveBullets(World& world) {
+    int capacity = bulletCapacityFor(world.cols, world.rows, world.enemies.count);
+    if (world.bullets.capacity < capacity)
+        initBulletPool(world.bullets, capacity);
+}
+
+// Thêm đạn vào kho của world, đếm lại viên bị bỏ khi kho đầy
+static void spawnBullet(World& world, const Bullet& bullet) {
+    if (addBullet(world.bullets, bullet)) world.changes++;
+    else world.droppedBullets++;
+}
+
+void initWorld(World& world, int cols, int rows, int enemyCount, unsigned long long seed) {
+    seedRng(world.rng, seed);
+    world.cols = cols;
+    world.rows = rows;
+    world.chunkCols = chunksFor(cols);
+    world.width = cols * CELL_SIZE;
+    world.height = rows * CELL_SIZE;
+
+    // Xe tăng của người chơi, xuất hiện ở góc trái dưới cùng
+    world.tank = {0, (rows - 1) * CELL_SIZE, TANK_SIZE, TANK_SIZE};
+    world.playerAlive = true;
+    world.tankAngle = 0.0;
+
+    initBitGrid(world.obstacleBits, cols, rows);
+    initBitGrid(world.enemyBits, cols, rows);
+    initBitGrid(world.playerBits, cols, rows);
+    initBitGrid(world.explosiveBits, cols, rows);
+    world.pendingExplosions.clear();
+    world.changedCells.clear();
+    world.changes = 0;
+    initGrid(world.enemyGrid, cols, rows);
+    setCell(world.playerBits, cellIndex(world, 0, rows - 1));
+
+    // Sắp xếp chướng ngại vật theo lưới: vị trí (1+2*j, 1+2*i)
+    for (int i = 0; i < rows / 2; i++) {
+        for (int j = 0; j < cols / 2; j++) {
+            setCell(world.obstacleBits, cellIndex(world, 1 + j * 2, 1 + i * 2));
+        }
+    }
+
+    // Xe địch đứng trên các ô chẵn (không có chướng ngại vật), trừ ô của người chơi.
+    // Đồng hồ của xe tính từ timeMs nên đặt lại trước khi sinh xe
+    world.timeMs = 0;
+    clearEnemies(world.enemies);
+    for (int cy = 0; cy < rows && world.enemies.count < enemyCount; cy += 2) {
+        for (int cx = 0; cx < cols && world.enemies.count < enemyCount; cx += 2) {
+            if (cx * CELL_SIZE == world.tank.x && cy * CELL_SIZE == world.tank.y) continue;
+            spawnEnemy(world, cx, cy);
+        }
+    }
+
+    reserveBullets(world);
+    world.bullets.count = 0;
+    world.droppedBullets = 0;
+    world.tick = 0;
+    world.tickMs = TICK_MS;
+}
+
+bool validMap(int cols, int rows, int enemyCount) {
+    if (cols < 1 || rows < 1 || cols > MAX_MAP_SIDE || rows > MAX_MAP_SIDE || enemyCount < 0) return false;
+    // Ô chẵn (cx, cy đều chẵn) không có chướng ngại vật; ô của người chơi (0, rows - 1) không tính
+    int freeCells = ((cols + 1) / 2) * ((rows + 1) / 2) - ((rows - 1) % 2 == 0 ? 1 : 0);
+    return enemyCount <= freeCells;
+}
+
+void initWorld(World& world, unsigned long long seed) {
+    initWorld(world, GRID_SIZE, GRID_SIZE, 0, seed);
+
+    // Xe địch: 5 xe tại vị trí cố định ban đầu
+    const int enemyCells[ENEMY_COUNT][2] = {{1, 1}, {3, 1}, {5, 1}, {7, 1}, {7, 2}};
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        spawnEnemy(world, enemyCells[i][0], enemyCells[i][1]);
+    }
+    reserveBullets(world);
+}
+
+bool checkCollision(Rect a, Rect b) {
+    return (a.x < b.x + b.w && a.x + a.w > b.x &&
+            a.y < b.y + b.h && a.y + a.h > b.y);
+}
+
+// Khoảng ô [c0, c1] x [r0, r1] mà rect phủ lên, đã cắt theo bản đồ
+static void cellRange(const World& world, const Rect& rect, int& c0, int& c1, int& r0, int& r1) {
+    c0 = rect.x / CELL_SIZE;
+    r0 = rect.y / CELL_SIZE;
+    c1 = (rect.x + rect.w - 1) / CELL_SIZE;
+    r1 = (rect.y + rect.h - 1) / CELL_SIZE;
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 >= world.cols) c1 = world.cols - 1;
+    if (r1 >= world.rows) r1 = world.rows - 1;
+}
+
+int cellContents(const World& world, int cx, int cy) {
+    int cell = cellIndex(world, cx, cy);
+    int flags = CELL_EMPTY;
+    if (testCell(world.obstacleBits, cell)) flags |= CELL_OBSTACLE;
+    if (testCell(world.enemyBits, cell)) flags |= CELL_ENEMY;
+    if (testCell(world.playerBits, cell)) flags |= CELL_PLAYER;
+    if (testCell(world.explosiveBits, cell)) flags |= CELL_EXPLOSIVE;
+    return flags;
+}
+
+void addExplosiveTile(World& world, int cx, int cy) {
+    setCell(world.obstacleBits, cellIndex(world, cx, cy));
+    setCell(world.explosiveBits, cellIndex(world, cx, cy));
+    world.changedCells.push_back(cellIndex(world, cx, cy));
+}
+
+// Vùng nổ 3x3 ô quanh tâm (centerX, centerY), đưa vào hàng đợi để xử lý cuối tick
+static void queueExplosion(World& world, int centerX, int centerY) {
+    Rect explosion;
+    explosion.w = 3 * CELL_SIZE;
+    explosion.h = 3 * CELL_SIZE;
+    explosion.x = centerX - explosion.w / 2;
+    explosion.y = centerY - explosion.h / 2;
+    world.pendingExplosions.push_back(explosion);
+}
+
+// Phá chướng ngại vật ở một ô; nếu là ô nổ thì xếp hàng một vụ nổ tại tâm ô
+static void destroyObstacle(World& world, int cell) {
+    clearCell(world.obstacleBits, cell);
+    world.changedCells.push_back(cell);
+    world.changes++;
+    if (testCell(world.explosiveBits, cell)) {
+        clearCell(world.explosiveBits, cell); // Mỗi ô nổ chỉ kích nổ một lần
+        queueExplosion(world, cellX(world, cell) * CELL_SIZE + CELL_SIZE / 2,
+                       cellY(world, cell) * CELL_SIZE + CELL_SIZE / 2);
+    }
+}
+
+// Kiểm tra ô mới có nằm trong bản đồ và không có chướng ngại vật
+// (xe tăng luôn đứng khớp đúng một ô nên chỉ cần đọc một bit)
+static bool canMoveTo(const World& world, const Rect& newPos) {
+    if (newPos.x < 0 || newPos.x + TANK_SIZE > world.width ||
+        newPos.y < 0 || newPos.y + TANK_SIZE > world.height)
+        return false;
+    return !testCell(world.obstacleBits, cellOf(world, newPos.x, newPos.y));
+}
+
+// Hàm bắn đạn của người chơi; nếu large==true thì bắn đạn 3x3, ngược lại bắn đạn 1x1
+// (Đạn của người chơi có isEnemy = false)
+void shootBullet(World& world, bool large) {
+    int bulletSize = large ? BULLET_SIZE_LARGE : BULLET_SIZE_SMALL;
+    int speed = large ? BULLET_SPEED_LARGE : BULLET_SPEED_SMALL;
+    int dx = 0, dy = 0;
+    if (world.tankAngle == 0.0)       { dy = -speed; }
+    else if (world.tankAngle == 180.0){ dy =  speed; }
+    else if (world.tankAngle == 90.0) { dx =  speed; }
+    else if (world.tankAngle == 270.0){ dx = -speed; }
+
+    Bullet bullet;
+    bullet.rect.w = bulletSize;
+    bullet.rect.h = bulletSize;
+    bullet.rect.x = world.tank.x + TANK_SIZE / 2 - bulletSize / 2;
+    bullet.rect.y = world.tank.y + TANK_SIZE / 2 - bulletSize / 2;
+    bullet.dx = dx;
+    bullet.dy = dy;
+    bullet.large = large;
+    bullet.isEnemy = false;
+    spawnBullet(world, bullet);
+}
+
+// Di chuyển và bắn đạn của người chơi (tương ứng handleInput trong ngay4.cpp)
+void applyInput(World& world, const Input& input) {
+    double oldAngle = world.tankAngle;
+    int dx = 0, dy = 0;
+    switch (input.move) {
+        case MOVE_UP:    dy = -CELL_SIZE; world.tankAngle = 0.0;   break;
+        case MOVE_DOWN:  dy =  CELL_SIZE; world.tankAngle = 180.0; break;
+        case MOVE_LEFT:  dx = -CELL_SIZE; world.tankAngle = 270.0; break;
+        case MOVE_RIGHT: dx =  CELL_SIZE; world.tankAngle = 90.0;  break;
+    }
+    if (world.tankAngle != oldAngle) world.changes++;
+    if (input.shootSmall) shootBullet(world, false);
+    if (input.shootLarge) shootBullet(world, true);
+
+    if ((dx != 0 || dy != 0) && world.playerAlive) {
+        Rect newTankPos = {world.tank.x + dx, world.tank.y + dy, TANK_SIZE, TANK_SIZE};
+        if (canMoveTo(world, newTankPos)) {
+            clearCell(world.playerBits, cellOf(world, world.tank.x, world.tank.y));
+            world.tank.x += dx;
+            world.tank.y += dy;
+            setCell(world.playerBits, cellOf(world, world.tank.x, world.tank.y));
+            world.changes++;
+        }
+    }
+}
+
+// Lịch kế tiếp của một đồng hồ lệch pha: giữ đúng chu kỳ, nhưng tick dài hơn chu kỳ
+// thì bỏ qua các lần đã lỡ thay vì chạy bù nhiều lần liền
+static unsigned int nextDue(unsigned int due, unsigned int now, int period) {
+    due += period;
+    return due > now ? due : now + period;
+}
+
+// Di chuyển xe địch ngẫu nhiên: mỗi tick chỉ các xe đã tới lượt (đồng hồ riêng từng xe)
+void moveEnemies(World& world) {
+    int directions[4][2] = {{0, -CELL_SIZE}, {0, CELL_SIZE}, {-CELL_SIZE, 0}, {CELL_SIZE, 0}};
+    double angles[4] = {0.0, 180.0, 270.0, 90.0};
+
+    EnemyStore& enemies = world.enemies;
+    world.dueEnemies.clear();
+    for (int i = 0; i < enemies.count; i++) {
+        if (world.timeMs >= enemies.nextMove[i]) world.dueEnemies.push_back(i);
+    }
+    if (world.dueEnemies.empty()) return;
+
+    // Rút hướng cho mọi xe tới lượt một lượt (2 bit mỗi xe) thay vì mỗi xe một lần gọi
+    int dueCount = world.dueEnemies.size();
+    world.enemyDirections.resize(dueCount);
+    randomDirections(world.rng, world.enemyDirections.data(), dueCount);
+
+    // Di chuyển không đổi thứ tự trong kho (chỉ xe chết mới bị dời), nên vị trí dày còn đúng
+    for (int k = 0; k < dueCount; k++) {
+        int i = world.dueEnemies[k];
+        enemies.nextMove[i] = nextDue(enemies.nextMove[i], world.timeMs, MOVE_DELAY);
+        int randomDir = world.enemyDirections[k];
+        int dx = directions[randomDir][0];
+        int dy = directions[randomDir][1];
+        Rect newEnemyPos = {enemies.x[i] + dx, enemies.y[i] + dy, TANK_SIZE, TANK_SIZE};
+        if (canMoveTo(world, newEnemyPos)) {
+            int slot = enemies.slot[i];
+            int oldCell = world.enemyGrid.entityCell[slot];
+            int newCell = cellOf(world, newEnemyPos.x, newEnemyPos.y);
+            enemies.x[i] = newEnemyPos.x;
+            enemies.y[i] = newEnemyPos.y;
+            enemies.angle[i] = angles[randomDir];
+            gridMove(world.enemyGrid, slot, newCell);
+            setEnemyCell(world, oldCell);
+            setCell(world.enemyBits, newCell);
+            world.changes++;
+        }
+    }
+}
+
+// Hàm bắn đạn của xe địch: mỗi xe địch còn sống bắn 1 viên đạn 1x1 theo hướng đang quay mỗi
+// 1 giây, theo đồng hồ riêng nên các xe không bắn cùng một tick. (Đạn của xe địch có isEnemy = true)
+void enemyShoot(World& world) {
+    EnemyStore& enemies = world.enemies;
+    for (int i = 0; i < enemies.count; i++) {
+        if (world.timeMs < enemies.nextShoot[i]) continue;
+        enemies.nextShoot[i] = nextDue(enemies.nextShoot[i], world.timeMs, ENEMY_SHOOT_DELAY);
+        int dx = 0, dy = 0;
+        // Xác định hướng bắn dựa trên góc quay hiện tại của xe địch
+        if (enemies.angle[i] == 0.0)       { dy = -BULLET_SPEED_SMALL; }  // lên
+        else if (enemies.angle[i] == 180.0){ dy =  BULLET_SPEED_SMALL; }  // xuống
+        else if (enemies.angle[i] == 90.0) { dx =  BULLET_SPEED_SMALL; }  // phải
+        else if (enemies.angle[i] == 270.0){ dx = -BULLET_SPEED_SMALL; }  // trái
+
+        Bullet bullet;
+        bullet.rect.w = BULLET_SIZE_SMALL;
+        bullet.rect.h = BULLET_SIZE_SMALL;
+        bullet.rect.x = enemies.x[i] + TANK_SIZE / 2 - BULLET_SIZE_SMALL / 2;
+        bullet.rect.y = enemies.y[i] + TANK_SIZE / 2 - BULLET_SIZE_SMALL / 2;
+        bullet.dx = dx;
+        bullet.dy = dy;
+        bullet.large = false;  // luôn là đạn 1x1
+        bullet.isEnemy = true;
+        spawnBullet(world, bullet);
+    }
+}
+
+// Một trục của phép quét AABB: thu hẹp khoảng thời gian [tEnter, tExit] mà
+// đoạn [a0, a0 + aSize) di chuyển d chồng lên đoạn [b0, b0 + bSize)
+static bool sweepAxis(int a0, int aSize, int d, int b0, int bSize, double& tEnter, double& tExit) {
+    if (d == 0) return a0 < b0 + bSize && a0 + aSize > b0;
+    double t0 = (double)(b0 - (a0 + aSize)) / d;
+    double t1 = (double)(b0 + bSize - a0) / d;
+    if (t0 > t1) std::swap(t0, t1);
+    if (t0 > tEnter) tEnter = t0;
+    if (t1 < tExit) tExit = t1;
+    return tEnter < tExit;
+}
+
+bool sweepRect(Rect a, int dx, int dy, Rect b, double& t) {
+    double tEnter = 0.0, tExit = 1.0;
+    if (!sweepAxis(a.x, a.w, dx, b.x, b.w, tEnter, tExit)) return false;
+    if (!sweepAxis(a.y, a.h, dy, b.y, b.h, tEnter, tExit)) return false;
+    t = tEnter;
+    return true;
+}
+
+// Va chạm đầu tiên trên đường đi của một viên đạn trong tick.
+// Cùng thời điểm thì ưu tiên theo thứ tự kiểm tra cũ: chướng ngại vật, người chơi, xe địch.
+enum HitKind { HIT_OBSTACLE, HIT_PLAYER, HIT_ENEMY, HIT_BORDER, HIT_NONE };
+
+struct SweepHit {
+    int kind;   // một giá trị của HitKind
+    int target; // ô chướng ngại vật hoặc ô handle của xe địch
+    double t;   // thời điểm va chạm trong tick, [0, 1)
+};
+
+static bool isBetterHit(const SweepHit& h, const SweepHit& best) {
+    if (h.t != best.t) return h.t < best.t;
+    if (h.kind != best.kind) return h.kind < best.kind;
+    return h.target < best.target;
+}
+
+// Thời điểm rect bắt đầu ra khỏi bản đồ khi di chuyển (dx, dy), 1 nếu vẫn ở trong
+static double borderTime(const World& world, const Rect& a, int dx, int dy) {
+    double t = 1.0;
+    if (dx > 0) t = std::min(t, (double)(world.width - (a.x + a.w)) / dx);
+    if (dx < 0) t = std::min(t, (double)a.x / -dx);
+    if (dy > 0) t = std::min(t, (double)(world.height - (a.y + a.h)) / dy);
+    if (dy < 0) t = std::min(t, (double)a.y / -dy);
+    return std::max(t, 0.0);
+}
+
+// Quét cả đoạn đường đạn đi trong tick để đạn nhanh không xuyên qua vật thể.
+// Các ô trong hộp bao đường quét được duyệt theo từng cột (hoặc hàng) dọc chiều
+// di chuyển chính và dừng ngay khi cột tiếp theo không thể chạm sớm hơn va chạm đã tìm thấy.
+static SweepHit sweepBullet(const World& world, const Rect& a, int dx, int dy, bool isEnemy) {
+    SweepHit best = {HIT_NONE, -1, 1.0};
+    double tBorder = borderTime(world, a, dx, dy);
+    if (tBorder < 1.0) best = {HIT_BORDER, -1, tBorder};
+
+    Rect box = {std::min(a.x, a.x + dx), std::min(a.y, a.y + dy), a.w + std::abs(dx), a.h + std::abs(dy)};
+    int c0, c1, r0, r1;
+    cellRange(world, box, c0, c1, r0, r1);
+    if (c0 > c1 || r0 > r1) return best;
+
+    bool alongX = std::abs(dx) >= std::abs(dy);
+    int d = alongX ? dx : dy;
+    int lineFirst = alongX ? (d < 0 ? c1 : c0) : (d < 0 ? r1 : r0);
+    int lineLast = alongX ? (d < 0 ? c0 : c1) : (d < 0 ? r0 : r1);
+    int lineStep = d < 0 ? -1 : 1;
+    int lead = alongX ? (d < 0 ? a.x : a.x + a.w) : (d < 0 ? a.y : a.y + a.h);
+
+    for (int line = lineFirst; ; line += lineStep) {
+        // Thời điểm sớm nhất đạn có thể chạm tới cột (hàng) này
+        if (d != 0) {
+            int edge = d > 0 ? line * CELL_SIZE : (line + 1) * CELL_SIZE;
+            double tLine = (double)(edge - lead) / d;
+            if (tLine > best.t) break;
+        }
+        int k0 = alongX ? r0 : c0;
+        int k1 = alongX ? r1 : c1;
+        for (int k = k0; k <= k1; k++) {
+            int cx = alongX ? line : k;
+            int cy = alongX ? k : line;
+            int cell = cellIndex(world, cx, cy);
+            if (testCell(world.obstacleBits, cell)) {
+                Rect cellRect = {cx * CELL_SIZE, cy * CELL_SIZE, CELL_SIZE, CELL_SIZE};
+                SweepHit h = {HIT_OBSTACLE, cell, 0.0};
+                if (sweepRect(a, dx, dy, cellRect, h.t) && isBetterHit(h, best)) best = h;
+            }
+            for (int e = firstInCell(world.enemyGrid, cell); e != -1; e = world.enemyGrid.nextInCell[e]) {
+                SweepHit h = {HIT_ENEMY, e, 0.0};
+                Rect enemy = enemyRect(world.enemies, world.enemies.index[e]);
+                if (sweepRect(a, dx, dy, enemy, h.t) && isBetterHit(h, best)) best = h;
+            }
+        }
+        if (line == lineLast) break;
+    }
+
+    // Chỉ đạn của xe địch mới bắn trúng người chơi
+    if (isEnemy && world.playerAlive) {
+        SweepHit h = {HIT_PLAYER, 0, 0.0};
+        if (sweepRect(a, dx, dy, world.tank, h.t) && isBetterHit(h, best)) best = h;
+    }
+    return best;
+}
+
+// Xử lý mọi vụ nổ trong hàng đợi trong một lượt. Mỗi vụ nổ chỉ xét các ô nó phủ
+// lên (chướng ngại vật qua lưới bit, xe địch qua enemyGrid), nên chi phí theo kích
+// thước vùng nổ chứ không theo kích thước bản đồ. Ô nổ bị phá thêm vụ nổ mới vào
+// cuối hàng đợi và được xử lý ngay trong lượt này.
+static void resolveExplosions(World& world) {
+    for (size_t i = 0; i < world.pendingExplosions.size(); i++) {
+        Rect explosion = world.pendingExplosions[i];
+        int c0, c1, r0, r1;
+        cellRange(world, explosion, c0, c1, r0, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                int cell = cellIndex(world, c, r);
+                // Chướng ngại vật lấp đầy ô nên ô bị phủ là bị phá
+                if (testCell(world.obstacleBits, cell))
+                    destroyObstacle(world, cell);
+                for (int e = firstInCell(world.enemyGrid, cell); e != -1; ) {
+                    int next = world.enemyGrid.nextInCell[e];
+                    if (checkCollision(explosion, enemyRect(world.enemies, world.enemies.index[e])))
+                        killEnemy(world, e);
+                    e = next;
+                }
+            }
+        }
+        if (world.playerAlive && checkCollision(world.tank, explosion))
+            killPlayer(world);
+    }
+    world.pendingExplosions.clear();
+}
+
+// Cập nhật vị trí các viên đạn và xử lý va chạm.
+// Va chạm được tìm trên cả đường đi trong tick (sweepBullet), nên tốc độ đạn
+// hay độ dài tick lớn cũng không làm đạn xuyên qua chướng ngại vật và xe tăng.
+void updateBullets(World& world) {
+    BulletPool& pool = world.bullets;
+    if (pool.count > 0) world.changes++; // Đạn bay mỗi tick
+    // Duyệt ngược nên viên cuối được chuyển vào chỗ trống đã được cập nhật rồi
+    for (int i = pool.count - 1; i >= 0; i--) {
+        // Vận tốc đạn tính cho tick chuẩn TICK_MS, đổi theo độ dài tick hiện tại; phần lẻ
+        // không đủ một px được cộng dồn sang tick sau thay vì bị cắt bỏ
+        int moveX = pool.dx[i] * world.tickMs + pool.remX[i];
+        int moveY = pool.dy[i] * world.tickMs + pool.remY[i];
+        int dx = moveX / TICK_MS;
+        int dy = moveY / TICK_MS;
+        pool.remX[i] = moveX - dx * TICK_MS;
+        pool.remY[i] = moveY - dy * TICK_MS;
+        Rect rect = bulletRect(pool, i);
+        bool large = pool.large[i];
+        bool isEnemy = pool.isEnemy[i];
+
+        SweepHit hit = sweepBullet(world, rect, dx, dy, isEnemy);
+        if (hit.kind == HIT_NONE) {
+            pool.x[i] += dx;
+            pool.y[i] += dy;
+            continue;
+        }
+
+        // Vị trí đạn tại thời điểm va chạm
+        rect.x += (int)(dx * hit.t);
+        rect.y += (int)(dy * hit.t);
+        bool triggerExplosion = false; // Áp dụng cho đạn của người chơi lớn
+
+        switch (hit.kind) {
+            case HIT_BORDER:
+                // Ra khỏi bản đồ: đạn người chơi lớn vẫn kích hoạt vùng nổ
+                triggerExplosion = !isEnemy && large;
+                break;
+            case HIT_OBSTACLE:
+                destroyObstacle(world, hit.target);
+                triggerExplosion = !isEnemy && large;
+                break;
+            case HIT_PLAYER:
+                killPlayer(world);
+                break;
+            case HIT_ENEMY:
+                // Đạn của xe địch trúng xe địch khác thì chỉ bị xóa
+                if (!isEnemy) {
+                    killEnemy(world, hit.target);
+                    triggerExplosion = large;
+                }
+                break;
+        }
+
+        if (triggerExplosion)
+            queueExplosion(world, rect.x + rect.w / 2, rect.y + rect.h / 2);
+        removeBulletAt(pool, i);
+    }
+
+    // Mọi vụ nổ của tick (nhiều tên lửa cùng lúc và nổ dây chuyền) xử lý chung một lượt
+    resolveExplosions(world);
+}
+
+void updateWorld(World& world) {
+    {
+        ProfileScope scope(world.profiler, PHASE_MOVE_ENEMIES);
+        moveEnemies(world);
+    }
+    {
+        ProfileScope scope(world.profiler, PHASE_ENEMY_SHOOT);
+        enemyShoot(world);  // Mỗi 1 giây, các xe địch bắn đạn
+    }
+    {
+        ProfileScope scope(world.profiler, PHASE_UPDATE_BULLETS);
+        updateBullets(world);
+    }
+    world.timeMs += world.tickMs;
+    world.tick++;
+}
+
+void step(World& world, const Input& input) {
+    applyInput(world, input);
+    updateWorld(world);
+}
+
+bool isGameOver(const World& world) {
+    return !world.playerAlive || world.enemies.count == 0;
+}
+
+// Số ô trống liên tiếp từ ô (cx, cy) theo hướng (stepX, stepY), không tính ô đầu, tối đa
+// limit: dừng ở chướng ngại vật, xe địch hoặc mép bản đồ (nơi đạn sẽ dừng lại)
+static int freeCellsAhead(const World& world, int cx, int cy, int stepX, int stepY, int limit) {
+    int count = 0;
+    while (count < limit) {
+        cx += stepX;
+        cy += stepY;
+        if (cx < 0 || cy < 0 || cx >= world.cols || cy >= world.rows) break;
+        int cell = cellIndex(world, cx, cy);
+        if (testCell(world.obstacleBits, cell) || testCell(world.enemyBits, cell)) break;
+        count++;
+    }
+    return count;
+}
+
+Input botInput(const World& world, Rng& botRng) {
+    Input input = {MOVE_NONE, false, false};
+    if (world.tick % 8 == 0) {
+        input.move = 1 + randomBelow(botRng, 4);
+        input.shootSmall = randomBelow(botRng, 3) == 0;
+        input.shootLarge = randomBelow(botRng, 10) == 0;
+
+        // Đạn bắn trước khi xe di chuyển, theo hướng mới. Tên lửa nổ 3x3 ô quanh chỗ trúng:
+        // trúng vật ở ô kề bên hoặc cách một ô trống thì vùng nổ phủ lên chính xe người chơi,
+        // nên chỉ bắn khi có ít nhất 2 ô trống phía trước (nổ dây chuyền của ô nổ không xét)
+        int stepX = input.move == MOVE_LEFT ? -1 : input.move == MOVE_RIGHT ? 1 : 0;
+        int stepY = input.move == MOVE_UP ? -1 : input.move == MOVE_DOWN ? 1 : 0;
+        if (input.shootLarge &&
+            freeCellsAhead(world, world.tank.x / CELL_SIZE, world.tank.y / CELL_SIZE, stepX, stepY, 2) < 2)
+            input.shootLarge = false;
+    }
+    return input;
+}
@@ -0,0 +1,232 @@
+#pragma once
+// Lõi mô phỏng của ngay4.cpp, tách khỏi SDL để chạy không cần cửa sổ.
+// Toàn bộ trạng thái trận đấu nằm trong World, thời gian tính bằng tick
+// (mỗi tick = TICK_MS) thay cho SDL_GetTicks().
+#include <vector>
+#include "luoi.h"
+#include "ngaunhien.h"
+
+struct Profiler; // hieunang.h
+
+// Kích thước màn hình và bản đồ
+const int SCREEN_WIDTH = 840;
+const int SCREEN_HEIGHT = 840;
+const int GRID_SIZE = 12;
+const int CELL_SIZE = SCREEN_WIDTH / GRID_SIZE;
+const int TANK_SIZE = CELL_SIZE;
+const int OBSTACLE_ROWS = 6;
+const int OBSTACLE_COLS = 6;
+const int ENEMY_COUNT = 5;
+const int MOVE_DELAY = 500;        // Độ trễ di chuyển xe địch (ms)
+const int ENEMY_SHOOT_DELAY = 1000; // Xe địch bắn mỗi 1 giây
+const int TICK_MS = 16;            // Một tick mô phỏng ~ một khung hình 60 FPS
+const int MAX_TICK_MS = 1000;      // Tick dài nhất nhận từ file replay hay dòng lệnh
+const int MAX_MAP_SIDE = 1024;     // Cạnh bản đồ lớn nhất (ô) nhận từ file replay hay dòng lệnh
+const int MAX_REPLAY_TICKS = 60 * 60 * 1000 / TICK_MS; // Trận dài nhất nhận từ file replay: một giờ ở TICK_MS
+
+// Các hằng số cho đạn
+const int BULLET_SIZE_SMALL = TANK_SIZE / 3; // 1/5 của ô vuông
+const int BULLET_SIZE_LARGE = TANK_SIZE / 2; // 1/3 của ô vuông
+const int BULLET_SPEED_SMALL = 6;            // tốc độ đạn nhỏ
+const int BULLET_SPEED_LARGE = 3;            // tốc độ đạn lớn
+
+// Hình chữ nhật giống SDL_Rect nhưng không phụ thuộc SDL
+struct Rect {
+    int x, y, w, h;
+};
+
+// Cấu trúc lưu thông tin đạn
+struct Bullet {
+    Rect rect;
+    int dx, dy;      // Vận tốc theo x, y
+    bool large;      // true: đạn 3x3, false: đạn 1x1
+    bool isEnemy;    // true: đạn của xe địch, false: của người chơi
+};
+
+// Kho đạn dung lượng cố định, lưu theo từng mảng thành phần (SoA).
+// Xóa đạn bằng cách đưa viên cuối vào chỗ trống (O(1), không giữ thứ tự),
+// nên khi đã cấp phát xong thì không cấp phát thêm trong lúc chơi.
+// initWorld cấp kho theo bulletCapacityFor, không nhỏ hơn MAX_BULLETS.
+const int MAX_BULLETS = 4096;
+
+struct BulletPool {
+    int capacity = 0;
+    int count = 0;
+    std::vector<int> x, y, w, h;
+    std::vector<int> dx, dy;
+    std::vector<int> remX, remY; // Phần lẻ quãng đường chưa đi, đơn vị 1/TICK_MS px, để tick dài ngắn nào đạn cũng đi đúng tốc độ
+    std::vector<unsigned char> large, isEnemy;
+};
+
+void initBulletPool(BulletPool& pool, int capacity);
+// Thêm đạn; trả về false nếu kho đã đầy (viên đạn bị bỏ qua)
+bool addBullet(BulletPool& pool, const Bullet& bullet);
+// Xóa đạn i bằng cách chuyển viên cuối vào vị trí i
+void removeBulletAt(BulletPool& pool, int i);
+Rect bulletRect(const BulletPool& pool, int i);
+
+// Số đạn tối đa có thể cùng bay trên bản đồ cols x rows với enemyCount xe địch ở
+// TICK_MS: mỗi xe một viên mỗi ENEMY_SHOOT_DELAY, người chơi hai viên mỗi tick, và
+// đạn bay hết chiều dài bản đồ (giới hạn trên, thực tế đạn dừng sớm hơn nhiều)
+int bulletCapacityFor(int cols, int rows, int enemyCount);
+
+// Kho xe địch: các thành phần lưu theo mảng dày (SoA) và chỉ gồm xe còn sống
+// ở [0, count), nên mọi vòng lặp chỉ đi qua xe còn sống. Xe chết được xóa bằng
+// cách đưa xe cuối vào chỗ trống như kho đạn. Mỗi xe có một handle (ô + thế hệ)
+// không đổi khi xe bị dời chỗ trong mảng dày; ô của xe chết được dùng lại cho xe
+// sinh sau với thế hệ mới, nên handle cũ không trỏ nhầm sang xe mới.
+// Bộ nhớ được giữ lại giữa các trận, chỉ cấp phát khi số xe vượt mức cũ.
+// Mỗi xe có đồng hồ di chuyển và bắn riêng, lệch pha theo ô handle (staggerPhase), nên
+// với hàng nghìn xe thì mỗi tick chỉ một phần nhỏ di chuyển hay bắn thay vì tất cả cùng lúc.
+struct EnemyHandle {
+    int slot;
+    unsigned int generation;
+};
+
+struct EnemyStore {
+    int count = 0;
+    std::vector<int> x, y;
+    std::vector<double> angle;
+    std::vector<unsigned int> nextMove;   // Thời điểm (ms) xe được di chuyển tiếp
+    std::vector<unsigned int> nextShoot;  // Thời điểm (ms) xe được bắn tiếp
+    std::vector<int> slot;                // Ô handle của xe ở vị trí dày i
+    std::vector<int> index;               // Vị trí dày của xe trong ô handle, -1 nếu ô trống
+    std::vector<unsigned int> generation; // Thế hệ hiện tại của từng ô handle
+    std::vector<int> freeSlots;
+};
+
+// Xóa mọi xe, giữ lại bộ nhớ để dùng cho trận sau
+void clearEnemies(EnemyStore& store);
+EnemyHandle addEnemyEntity(EnemyStore& store, int x, int y, double angle);
+// Xóa xe ở vị trí dày i bằng cách chuyển xe cuối vào vị trí i
+void removeEnemyAt(EnemyStore& store, int i);
+// Vị trí dày của xe có handle này, -1 nếu xe đã chết
+int findEnemy(const EnemyStore& store, EnemyHandle handle);
+Rect enemyRect(const EnemyStore& store, int i);
+
+// Hướng di chuyển của người chơi trong một tick
+enum Move { MOVE_NONE, MOVE_UP, MOVE_DOWN, MOVE_LEFT, MOVE_RIGHT };
+
+// Lệnh điều khiển của người chơi (thay cho phím bấm SDL)
+struct Input {
+    int move;        // một giá trị của Move
+    bool shootSmall; // phím N
+    bool shootLarge; // phím M
+};
+
+// Toàn bộ trạng thái của một trận đấu
+struct World {
+    int cols, rows;      // Kích thước bản đồ tính theo ô
+    int chunkCols;       // Số khối theo chiều ngang (xem luoi.h)
+    int width, height;   // Kích thước bản đồ tính theo pixel
+
+    Rect tank;
+    bool playerAlive;
+    double tankAngle;
+
+    EnemyStore enemies; // Chỉ gồm xe địch còn sống
+
+    // Các lớp chiếm ô, mỗi ô một bit (xem luoi.h)
+    BitGrid obstacleBits; // Ô có chướng ngại vật còn nguyên
+    BitGrid enemyBits;    // Ô có ít nhất một xe địch còn sống
+    BitGrid playerBits;   // Ô của xe người chơi
+    BitGrid explosiveBits; // Chướng ngại vật sẽ nổ 3x3 ô khi bị phá
+
+    // Chỉ mục theo ô cho xe địch, để biết ô nào có xe nào (theo ô handle của xe)
+    SpatialGrid enemyGrid;
+
+    BulletPool bullets;
+    unsigned int droppedBullets; // Số viên đạn bị bỏ vì kho đã đầy (không tính vào hashWorld)
+
+    // Các vùng nổ chờ xử lý trong tick; nổ dây chuyền được thêm vào cuối hàng đợi
+    std::vector<Rect> pendingExplosions;
+
+    // Ô có chướng ngại vật vừa đổi (bị phá, thêm ô nổ) kể từ lần phần vẽ lấy ra gần nhất,
+    // để chỉ vẽ lại các ô đó. Không thuộc trạng thái mô phỏng (không tính vào hashWorld);
+    // chạy không giao diện thì không ai lấy ra, nhưng mỗi ô chỉ bị phá một lần nên không tăng mãi.
+    std::vector<int> changedCells;
+
+    // Tăng mỗi khi có gì nhìn thấy được thay đổi (xe di chuyển hoặc quay, đạn, chướng ngại
+    // vật, xe chết), để phần vẽ bỏ qua khung hình giống hệt khung trước. Không tính vào hashWorld.
+    unsigned int changes;
+
+    Rng rng;                                  // Bộ sinh số riêng của trận, gieo trong initWorld
+    std::vector<int> dueEnemies;                // Xe đến lượt di chuyển trong tick (vị trí dày), dùng lại mỗi tick
+    std::vector<unsigned char> enemyDirections; // Hướng rút sẵn cho mỗi xe trong dueEnemies
+
+    unsigned int timeMs;              // Thời gian mô phỏng đã trôi qua
+    unsigned int tick;
+    int tickMs;                       // Độ dài một tick, mặc định TICK_MS; tick dài thì đạn đi xa hơn mỗi tick
+
+    // Nơi ghi thời gian từng phần của updateWorld; null thì không đo. Chỉ luồng chạy trận
+    // này được ghi vào đó, initWorld không đổi con trỏ này
+    Profiler* profiler = nullptr;
+};
+
+// Chỉ số ô (cx, cy) trong các lớp lưới của world, và ngược lại.
+// Ô được đánh số theo khối 64x64 (xem luoi.h), không phải cy * cols + cx.
+inline int cellIndex(const World& world, int cx, int cy) {
+    return tiledCell(world.chunkCols, cx, cy);
+}
+
+inline int cellX(const World& world, int cell) {
+    return tiledCellX(world.chunkCols, cell);
+}
+
+inline int cellY(const World& world, int cell) {
+    return tiledCellY(world.chunkCols, cell);
+}
+
+// Đưa world về trạng thái đầu trận như ngay4.cpp; seed quyết định toàn bộ
+// phần ngẫu nhiên của trận (cùng seed và cùng input thì cùng kết quả)
+void initWorld(World& world, unsigned long long seed);
+// Bản đồ cols x rows ô, chướng ngại vật xen kẽ như ngay4.cpp và enemyCount xe
+// địch xếp lần lượt trên các ô chẵn còn trống (dùng cho đo hiệu năng)
+void initWorld(World& world, int cols, int rows, int enemyCount, unsigned long long seed);
+// Kích thước và số xe địch initWorld(cols, rows, enemyCount) nhận được: cạnh trong
+// [1, MAX_MAP_SIDE] và không quá số ô chẵn còn trống. Dùng để kiểm tra dữ liệu từ ngoài
+// (file replay, dòng lệnh) trước khi cấp phát bản đồ
+bool validMap(int cols, int rows, int enemyCount);
+
+// Độ lệch pha trong [0, period) của xe ở ô handle slot: dãy tỉ lệ vàng nên các ô liên
+// tiếp rải đều trên cả chu kỳ
+inline unsigned int staggerPhase(int slot, int period) {
+    unsigned int fraction = (unsigned int)slot * 0x9E3779B9u;
+    return (unsigned int)(((unsigned long long)fraction * (unsigned int)period) >> 32);
+}
+
+// Sinh một xe địch tại ô (cx, cy) trong lúc chơi; xe di chuyển lần đầu sau tối đa
+// MOVE_DELAY ms và bắn lần đầu sau tối đa ENEMY_SHOOT_DELAY ms, tùy độ lệch pha
+EnemyHandle spawnEnemy(World& world, int cx, int cy);
+
+bool checkCollision(Rect a, Rect b);
+
+// Quét AABB: a di chuyển (dx, dy) trong một tick. Nếu a chồng lên b tại một thời
+// điểm nào đó trong tick thì trả về true và t là thời điểm bắt đầu chồng, trong [0, 1).
+bool sweepRect(Rect a, int dx, int dy, Rect b, double& t);
+
+// Nội dung của một ô, tổ hợp các cờ CELL_*
+enum CellFlag { CELL_EMPTY = 0, CELL_OBSTACLE = 1, CELL_ENEMY = 2, CELL_PLAYER = 4, CELL_EXPLOSIVE = 8 };
+int cellContents(const World& world, int cx, int cy);
+
+// Đặt một chướng ngại vật nổ tại ô (cx, cy): khi bị phá sẽ nổ 3x3 ô và có thể kích nổ dây chuyền
+void addExplosiveTile(World& world, int cx, int cy);
+
+void shootBullet(World& world, bool large);
+void applyInput(World& world, const Input& input);
+void moveEnemies(World& world);
+void enemyShoot(World& world);
+void updateBullets(World& world);
+
+// Một tick không có input: xe địch di chuyển, bắn và cập nhật đạn
+void updateWorld(World& world);
+// Một tick đầy đủ: áp dụng input rồi updateWorld
+void step(World& world, const Input& input);
+
+// Người chơi chết hoặc tất cả xe địch đã chết
+bool isGameOver(const World& world);
+
+// Người chơi tự động khi chạy không cần cửa sổ: cứ vài tick đổi hướng ngẫu nhiên và thỉnh thoảng bắn.
+// Bot dùng bộ sinh số riêng (botRng) để không làm lệch chuỗi số của xe địch,
+// nhờ vậy trận của bot ghi lại được và phát lại đúng.
+Input botInput(const World& world, Rng& botRng);
@@ -0,0 +1,56 @@
+#pragma once
+// Bộ sinh số ngẫu nhiên xoshiro256** riêng cho từng World, thay cho rand() dùng
+// chung cả chương trình. Trạng thái nằm trong struct nên mỗi trận (mỗi luồng)
+// có chuỗi số của riêng nó: cùng seed thì trận chạy lại y hệt.
+// Chỉ có header, không cần thêm file .cpp khi biên dịch.
+
+struct Rng {
+    unsigned long long s[4];
+};
+
+// Khởi tạo trạng thái từ seed bằng splitmix64 (seed nào cũng cho trạng thái khác 0)
+inline void seedRng(Rng& rng, unsigned long long seed) {
+    for (int i = 0; i < 4; i++) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        unsigned long long z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        rng.s[i] = z ^ (z >> 31);
+    }
+}
+
+inline unsigned long long rotateLeft(unsigned long long x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// 64 bit ngẫu nhiên tiếp theo
+inline unsigned long long nextRandom(Rng& rng) {
+    unsigned long long* s = rng.s;
+    unsigned long long result = rotateLeft(s[1] * 5, 7) * 9;
+    unsigned long long t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+// Số nguyên trong [0, n), n > 0. Nhân với 32 bit cao thay cho phép chia lấy dư
+inline int randomBelow(Rng& rng, int n) {
+    return (int)(((nextRandom(rng) >> 32) * (unsigned long long)n) >> 32);
+}
+
+// Điền count hướng ngẫu nhiên (0..3) vào out. Mỗi hướng chỉ cần 2 bit nên một
+// lần sinh 64 bit cho 32 hướng, thay vì gọi rand() cho từng xe.
+inline void randomDirections(Rng& rng, unsigned char* out, int count) {
+    for (int i = 0; i < count; i += 32) {
+        unsigned long long bits = nextRandom(rng);
+        int n = count - i < 32 ? count - i : 32;
+        for (int j = 0; j < n; j++) {
+            out[i + j] = bits & 3;
+            bits >>= 2;
+        }
+    }
+}
@@ -3,99 +3,122 @@
 #include <cstdlib>
 #include <ctime>
 #include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-
-// Kích thước màn hình và bản đồ
-const int SCREEN_WIDTH = 840;
-const int SCREEN_HEIGHT = 840;
-const int GRID_SIZE = 12;
-const int CELL_SIZE = SCREEN_WIDTH / GRID_SIZE;
-const int TANK_SIZE = CELL_SIZE;
-const int OBSTACLE_ROWS = 6;
-const int OBSTACLE_COLS = 6;
-const int ENEMY_COUNT = 5;
-const int MOVE_DELAY = 500; // Độ trễ di chuyển xe địch (ms)
-
-// Các hằng số cho đạn
-const int BULLET_SIZE_SMALL = TANK_SIZE / 3; // 1/5 của ô vuông
-const int BULLET_SIZE_LARGE = TANK_SIZE / 2; // 1/3 của ô vuông
-const int BULLET_SPEED_SMALL = 6;            // tốc độ đạn nhỏ
-const int BULLET_SPEED_LARGE = 3;            // tốc độ đạn lớn
-
-// Cấu trúc lưu thông tin đạn
-struct Bullet {
-    SDL_Rect rect;
-    int dx, dy;      // Vận tốc theo x, y
-    bool large;      // true: đạn 3x3, false: đạn 1x1
-    bool isEnemy;    // true: đạn của xe địch, false: của người chơi
-};
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "mophong.h" // Lõi mô phỏng: hằng số, World, moveEnemies, enemyShoot, updateBullets
+#include "phatlai.h" // Ghi lại phím bấm để phát lại trận
+#include "velo.h"    // Vẽ theo lô bằng SDL_RenderGeometry
+#include "tapanh.h"  // Mọi ảnh của game xếp chung một texture
+#include "goi.h"     // Gói tài nguyên tạo bởi donggoi, mở bằng mmap
+#include "hieunang.h" // Đo thời gian từng phần của vòng lặp
+
+// Biên dịch cùng lõi mô phỏng: g++ ngay4.cpp mophong.cpp luoi.cpp dan.cpp xedich.cpp phatlai.cpp velo.cpp tapanh.cpp goi.cpp hieunang.cpp -pthread -lSDL2main -lSDL2 -lSDL2_image
+// Tài nguyên lấy từ tainguyen.pak nếu có (tạo bằng donggoi), không thì đọc các file PNG như cũ
+// Cách dùng: ngay4                       (bản đồ 12x12 như cũ)
+//            ngay4 soCot soHang soXeDich (bản đồ lớn, camera đi theo xe người chơi)
+//            ngay4 --serial [...]        (nạp ảnh ở luồng chính sau khi tạo cửa sổ như trước đây,
+//                                         để đo thời gian tới khung hình đầu tiên khi không có luồng nền)
+//            ngay4 --headless file.rep [--hash] [--trace file.json]
+//                  (không cửa sổ: phát lại trận đã ghi, vẽ mọi tick bằng renderer phần mềm, đo thời gian vẽ)
+// Trong game: F3 bật/tắt bảng thời gian từng phần, F4 ghi trace ra hieunang.json
 
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
-SDL_Texture* tankTexture = nullptr;
-SDL_Texture* enemyTexture = nullptr;
-SDL_Texture* obstacleTexture = nullptr;
-
-// *** Thêm 2 biến toàn cục để tải ảnh đạn ***
-SDL_Texture* bulletTextureSmall = nullptr; // "dan.png"
-SDL_Texture* bulletTextureLarge = nullptr; // "tenlua.png"
-
-// Xe tăng của người chơi, xuất hiện ở góc trái dưới cùng
-SDL_Rect tank = {0, (GRID_SIZE - 1) * CELL_SIZE, TANK_SIZE, TANK_SIZE};
-bool playerAlive = true;
-
-// Chướng ngại vật: 6x6
-SDL_Rect obstacles[OBSTACLE_ROWS][OBSTACLE_COLS];
-
-// Xe địch: 5 xe tại vị trí cố định ban đầu
-SDL_Rect enemies[ENEMY_COUNT] = {
-    {CELL_SIZE, CELL_SIZE, TANK_SIZE, TANK_SIZE},
-    {3 * CELL_SIZE, CELL_SIZE, TANK_SIZE, TANK_SIZE},
-    {5 * CELL_SIZE, CELL_SIZE, TANK_SIZE, TANK_SIZE},
-    {7 * CELL_SIZE, CELL_SIZE, TANK_SIZE, TANK_SIZE},
-    {7 * CELL_SIZE, 2 * CELL_SIZE, TANK_SIZE, TANK_SIZE}
-};
-bool enemyAlive[ENEMY_COUNT] = { true, true, true, true, true };
-
-double tankAngle = 0.0;               // Góc quay của xe tăng người chơi
-double enemyAngles[ENEMY_COUNT] = {0}; // Góc quay của các xe địch
-Uint32 lastMoveTime = 0;             // Thời gian di chuyển xe địch
 
-// Biến toàn cục để theo dõi thời gian bắn đạn của xe địch
-Uint32 lastEnemyBulletTime = 0;
-
-// Danh sách đạn đang tồn tại
-std::vector<Bullet> bullets;
+// Tập ảnh chứa mọi ảnh của game; các biến *Sprite là chỉ số vùng ảnh, -1 nếu ảnh không tải được
+Atlas atlas;
+int tankSprite = -1;
+int enemySprite = -1;
+int obstacleSprite = -1;
+int bulletSmallSprite = -1; // "dan.png"
+int bulletLargeSprite = -1; // "tenlua.png"
+int whiteSprite = -1;       // Vùng trắng để tô màu nền đạn
+
+// Toàn bộ trạng thái trận đấu (xe tăng, xe địch, chướng ngại vật, đạn)
+World world;
+
+// Phím bấm chờ áp dụng ở đầu tick mô phỏng kế tiếp
+std::vector<Input> pendingInputs;
+
+// Trận đang chơi được ghi lại, lưu ra tran_cuoi.rep khi thoát (phát lại bằng chaymophong --replay)
+Replay replay;
+
+// Vị trí xe tăng ở tick trước, để vẽ nội suy giữa hai tick.
+// Xe địch đánh số theo ô handle vì thứ tự trong kho thay đổi khi có xe chết.
+Rect previousTank;
+std::vector<Rect> previousEnemies;
+
+// Góc trên trái của vùng bản đồ (pixel) đang hiện trong cửa sổ
+int cameraX = 0, cameraY = 0;
+
+// Mọi hình đều lấy từ texture của tập ảnh nên cả khung hình là một lô, một lệnh vẽ.
+// Thứ tự thêm vào lô là thứ tự vẽ.
+SpriteBatch sceneBatch;
+int drawCalls = 0; // Số lệnh vẽ của khung hình vừa vẽ
+
+// Lớp địa hình vẽ sẵn: chướng ngại vật được vẽ vào texture đích terrainTexture và chỉ
+// vẽ lại ô nào đổi (world.changedCells) hoặc vừa lộ ra khi camera di chuyển; mỗi khung
+// chỉ chép texture ra màn hình. Texture giữ TERRAIN_SPAN x TERRAIN_SPAN ô, đủ phủ màn hình
+// ở mọi vị trí camera; ô (cx, cy) nằm ở (cx % TERRAIN_SPAN, cy % TERRAIN_SPAN) nên bản đồ
+// lớn cuộn vòng trong texture thay vì cần một texture cỡ cả bản đồ.
+const int TERRAIN_SPAN = ((SCREEN_WIDTH > SCREEN_HEIGHT ? SCREEN_WIDTH : SCREEN_HEIGHT) + CELL_SIZE - 1) / CELL_SIZE + 1;
+const int TERRAIN_PIXELS = TERRAIN_SPAN * CELL_SIZE;
+SDL_Texture* terrainTexture = nullptr; // nullptr nếu renderer không có texture đích: vẽ từng ô vào lô như cũ
+bool terrainValid = false;             // false: phải vẽ lại cả texture (lần đầu, hoặc khi texture mất nội dung)
+int terrainCol = 0, terrainRow = 0;    // Ô trên trái của vùng bản đồ texture đang giữ
+std::vector<SDL_Rect> terrainClears;   // Ô cần vẽ lại trong khung này (tọa độ trong texture)
+SpriteBatch terrainBatch;              // Chướng ngại vật của các ô đó
+SpriteBatch terrainView;               // Phần texture hiện trên màn hình, tối đa 4 hình do cuộn vòng
+
+// Theo dõi thay đổi để bỏ qua khung hình giống hệt khung đã vẽ (xem sceneChanged)
+unsigned int changesBeforeTick = 0; // world.changes trước tick cuối; khác world.changes: tick cuối có vật di chuyển
+unsigned int drawnChanges = 0;      // world.changes lúc vẽ khung gần nhất
+bool drawnMoving = false;           // Khung gần nhất vẽ lúc đang nội suy, chưa tới vị trí cuối
+bool forceRedraw = true;            // Cửa sổ bị che, đổi cỡ hoặc texture mất nội dung: phải vẽ lại
+
+// Bảng thời gian từng phần (F3): mỗi phần một hàng, vạch sáng là p50, vạch mờ là p99 của
+// giây vừa qua, 16 ms dài OVERLAY_WIDTH pixel; số liệu hiện trên thanh tiêu đề.
+const int OVERLAY_WIDTH = 320;
+const int OVERLAY_ROW = 12;
+const SDL_Color PHASE_COLORS[PHASE_COUNT] = {
+    {200, 200, 200, 255}, {80, 200, 80, 255}, {230, 160, 40, 255},
+    {230, 70, 70, 255}, {80, 140, 240, 255}, {190, 90, 230, 255},
+};
+Profiler profiler; // Gắn vào world trong main; chỉ luồng chính ghi
+bool showProfile = false;
+PhaseStats profileStats[PHASE_COUNT] = {};
+std::vector<ProfileSample> profileSamples;
+
+const SDL_Color WHITE = {255, 255, 255, 255};
+const SDL_Color RED = {255, 0, 0, 255};
+const SDL_Color EXPLOSIVE_TINT = {255, 110, 110, 255}; // Ô nổ tô đỏ
+
+void savePreviousPositions() {
+    const EnemyStore& enemies = world.enemies;
+    previousTank = world.tank;
+    previousEnemies.resize(enemies.index.size());
+    for (int i = 0; i < enemies.count; i++)
+        previousEnemies[enemies.slot[i]] = enemyRect(enemies, i);
+}
 
 bool init() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) return false;
-    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) return false;
 
     window = SDL_CreateWindow("Battle City", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
                               SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
     if (!window) return false;
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     return renderer != nullptr;
 }
 
-SDL_Texture* loadTexture(const char* path) {
-    SDL_Texture* newTexture = nullptr;
-    SDL_Surface* loadedSurface = IMG_Load(path);
-    if (loadedSurface) {
-        newTexture = SDL_CreateTextureFromSurface(renderer, loadedSurface);
-        SDL_FreeSurface(loadedSurface);
-    }
-    return newTexture;
-}
-
 void close() {
-    SDL_DestroyTexture(tankTexture);
-    SDL_DestroyTexture(enemyTexture);
-    SDL_DestroyTexture(obstacleTexture);
-
-    // *** Hủy hai texture đạn đã thêm ***
-    SDL_DestroyTexture(bulletTextureSmall);
-    SDL_DestroyTexture(bulletTextureLarge);
+    destroyAtlas(atlas);
+    if (terrainTexture) SDL_DestroyTexture(terrainTexture);
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -103,339 +126,650 @@ void close() {
     SDL_Quit();
 }
 
-// Sắp xếp chướng ngại vật theo lưới: vị trí (1+2*j, 1+2*i)
-void setupObstacles() {
-    for (int i = 0; i < OBSTACLE_ROWS; i++) {
-        for (int j = 0; j < OBSTACLE_COLS; j++) {
-            obstacles[i][j].x = (1 + j * 2) * CELL_SIZE;
-            obstacles[i][j].y = (1 + i * 2) * CELL_SIZE;
-            obstacles[i][j].w = CELL_SIZE;
-            obstacles[i][j].h = CELL_SIZE;
-        }
-    }
+// Nội suy vị trí giữa tick trước (alpha = 0) và tick hiện tại (alpha = 1)
+SDL_Rect lerpRect(const Rect& from, const Rect& to, double alpha) {
+    SDL_Rect rect = {(int)(from.x + (to.x - from.x) * alpha), (int)(from.y + (to.y - from.y) * alpha), to.w, to.h};
+    return rect;
 }
 
-bool checkCollision(SDL_Rect a, SDL_Rect b) {
-    return (a.x < b.x + b.w && a.x + a.w > b.x &&
-            a.y < b.y + b.h && a.y + a.h > b.y);
+// Xử lý bàn phím: chuyển phím bấm thành Input, áp dụng ở đầu tick kế tiếp
+void handleInput(SDL_Event& event) {
+    if (event.type != SDL_KEYDOWN) return;
+    Input input = {MOVE_NONE, false, false};
+    switch (event.key.keysym.sym) {
+        case SDLK_UP:    input.move = MOVE_UP;    break;
+        case SDLK_DOWN:  input.move = MOVE_DOWN;  break;
+        case SDLK_LEFT:  input.move = MOVE_LEFT;  break;
+        case SDLK_RIGHT: input.move = MOVE_RIGHT; break;
+        case SDLK_n:     input.shootSmall = true; break; // bắn đạn 1x1 của người chơi
+        case SDLK_m:     input.shootLarge = true; break; // bắn đạn 3x3 của người chơi
+        default: return;
+    }
+    pendingInputs.push_back(input);
 }
 
-// Hàm bắn đạn của người chơi; nếu large==true thì bắn đạn 3x3, ngược lại bắn đạn 1x1
-// (Đạn của người chơi có isEnemy = false)
-void shootBullet(bool large) {
-    int bulletSize = large ? BULLET_SIZE_LARGE : BULLET_SIZE_SMALL;
-    int speed = large ? BULLET_SPEED_LARGE : BULLET_SPEED_SMALL;
-    int dx = 0, dy = 0;
-    if (tankAngle == 0.0)       { dy = -speed; }
-    else if (tankAngle == 180.0){ dy =  speed; }
-    else if (tankAngle == 90.0) { dx =  speed; }
-    else if (tankAngle == 270.0){ dx = -speed; }
-
-    SDL_Rect bulletRect;
-    bulletRect.w = bulletSize;
-    bulletRect.h = bulletSize;
-    bulletRect.x = tank.x + TANK_SIZE / 2 - bulletSize / 2;
-    bulletRect.y = tank.y + TANK_SIZE / 2 - bulletSize / 2;
-
-    Bullet bullet;
-    bullet.rect = bulletRect;
-    bullet.dx = dx;
-    bullet.dy = dy;
-    bullet.large = large;
-    bullet.isEnemy = false;
-    bullets.push_back(bullet);
+// Tạo texture địa hình; không được thì render() vẽ chướng ngại vật từng ô như cũ
+void createTerrain() {
+    terrainTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                       TERRAIN_PIXELS, TERRAIN_PIXELS);
+    // Ô trống tô đen đặc nên chép đè lên màn hình, không cần hòa trộn
+    if (terrainTexture) SDL_SetTextureBlendMode(terrainTexture, SDL_BLENDMODE_NONE);
+    terrainValid = false;
 }
 
-// Hàm bắn đạn của xe địch: cứ mỗi 1 giây, với mỗi xe địch còn sống bắn ra 1 viên đạn 1x1 theo hướng ngẫu nhiên.
-// (Đạn của xe địch có isEnemy = true)
-void enemyShoot() {
-    Uint32 currentTime = SDL_GetTicks();
-    if (currentTime - lastEnemyBulletTime < 1000) return; // mỗi 1 giây
-    lastEnemyBulletTime = currentTime;
-
-    for (int i = 0; i < ENEMY_COUNT; i++) {
-        if (!enemyAlive[i]) continue;
-
-        int dx = 0, dy = 0;
-        // Xác định hướng bắn dựa trên góc quay hiện tại của xe địch
-        if (enemyAngles[i] == 0.0)       { dy = -BULLET_SPEED_SMALL; }  // lên
-        else if (enemyAngles[i] == 180.0){ dy =  BULLET_SPEED_SMALL; }  // xuống
-        else if (enemyAngles[i] == 90.0) { dx =  BULLET_SPEED_SMALL; }  // phải
-        else if (enemyAngles[i] == 270.0){ dx = -BULLET_SPEED_SMALL; }  // trái
-
-        SDL_Rect bulletRect;
-        bulletRect.w = BULLET_SIZE_SMALL;
-        bulletRect.h = BULLET_SIZE_SMALL;
-        bulletRect.x = enemies[i].x + TANK_SIZE / 2 - BULLET_SIZE_SMALL / 2;
-        bulletRect.y = enemies[i].y + TANK_SIZE / 2 - BULLET_SIZE_SMALL / 2;
-
-        Bullet bullet;
-        bullet.rect = bulletRect;
-        bullet.dx = dx;
-        bullet.dy = dy;
-        bullet.large = false;  // luôn là đạn 1x1
-        bullet.isEnemy = true;
-        bullets.push_back(bullet);
+// Một tick mô phỏng: áp dụng phím bấm đang chờ rồi cập nhật world
+void tickWorld() {
+    savePreviousPositions();
+    changesBeforeTick = world.changes;
+    for (const Input& input : pendingInputs) {
+        recordInput(replay, world.tick, input);
+        applyInput(world, input);
     }
+    pendingInputs.clear();
+    updateWorld(world); // moveEnemies, enemyShoot, updateBullets
 }
 
-// Xử lý bàn phím: di chuyển và bắn đạn của người chơi
-void handleInput(SDL_Event& event) {
-    int dx = 0, dy = 0;
-    if (event.type == SDL_KEYDOWN) {
-        switch (event.key.keysym.sym) {
-            case SDLK_UP:    dy = -CELL_SIZE; tankAngle = 0.0;   break;
-            case SDLK_DOWN:  dy =  CELL_SIZE; tankAngle = 180.0; break;
-            case SDLK_LEFT:  dx = -CELL_SIZE; tankAngle = 270.0; break;
-            case SDLK_RIGHT: dx =  CELL_SIZE; tankAngle = 90.0;  break;
-            case SDLK_n:     // bắn đạn 1x1 của người chơi
-                shootBullet(false);
-                break;
-            case SDLK_m:     // bắn đạn 3x3 của người chơi
-                shootBullet(true);
-                break;
+// Thêm vùng ảnh sprite của tập ảnh vào lô; bỏ qua nếu ảnh không tải được.
+// Góc là bội của 90 và ảnh có bản xoay sẵn thì vẽ thẳng bản đó, không xoay lúc vẽ;
+// chỉ vật bay theo góc tùy ý mới phải xoay từng đỉnh.
+void drawSprite(int sprite, const SDL_Rect& rect, double angle, SDL_Color color) {
+    if (sprite < 0) return;
+    int turned = turnedSprite(atlas, sprite, angle);
+    if (turned >= 0) {
+        const AtlasSprite& region = atlas.sprites[turned];
+        SDL_Rect dst = rect;
+        if (region.rect.w != atlas.sprites[sprite].rect.w) {
+            // Xoay 90 hoặc 270 độ: đổi chiều rộng và chiều cao quanh tâm
+            dst = {rect.x + (rect.w - rect.h) / 2, rect.y + (rect.h - rect.w) / 2, rect.h, rect.w};
         }
+        addSpriteUV(sceneBatch, dst, 0.0, color, region.u0, region.v0, region.u1, region.v1);
+        return;
+    }
+    const AtlasSprite& region = atlas.sprites[sprite];
+    addSpriteUV(sceneBatch, rect, angle, color, region.u0, region.v0, region.u1, region.v1);
+}
 
-        if ((dx != 0 || dy != 0) && playerAlive) {
-            SDL_Rect newTankPos = {tank.x + dx, tank.y + dy, TANK_SIZE, TANK_SIZE};
-            if (newTankPos.x >= 0 && newTankPos.x + TANK_SIZE <= SCREEN_WIDTH &&
-                newTankPos.y >= 0 && newTankPos.y + TANK_SIZE <= SCREEN_HEIGHT) {
-                bool collision = false;
-                for (int i = 0; i < OBSTACLE_ROWS; i++) {
-                    for (int j = 0; j < OBSTACLE_COLS; j++) {
-                        if (checkCollision(newTankPos, obstacles[i][j])) {
-                            collision = true;
-                            break;
-                        }
-                    }
-                    if (collision) break;
-                }
-                if (!collision) {
-                    tank.x += dx;
-                    tank.y += dy;
-                }
+// Đặt camera để xe người chơi nằm giữa màn hình, không cho camera ra ngoài bản đồ
+void updateCamera(const SDL_Rect& tankRect) {
+    int maxX = world.width > SCREEN_WIDTH ? world.width - SCREEN_WIDTH : 0;
+    int maxY = world.height > SCREEN_HEIGHT ? world.height - SCREEN_HEIGHT : 0;
+    cameraX = std::min(std::max(tankRect.x + TANK_SIZE / 2 - SCREEN_WIDTH / 2, 0), maxX);
+    cameraY = std::min(std::max(tankRect.y + TANK_SIZE / 2 - SCREEN_HEIGHT / 2, 0), maxY);
+}
+
+// Đổi hình chữ nhật từ tọa độ bản đồ sang tọa độ màn hình; false nếu nằm ngoài màn hình
+bool toScreen(SDL_Rect& rect) {
+    rect.x -= cameraX;
+    rect.y -= cameraY;
+    return rect.x < SCREEN_WIDTH && rect.x + rect.w > 0 && rect.y < SCREEN_HEIGHT && rect.y + rect.h > 0;
+}
+
+// Đưa chướng ngại vật trong khoảng ô [c0, c1] x [r0, r1] vào lô: mỗi hàng chỉ đọc từ
+// 64 bit của các khối nằm trong khoảng đó, khối ngoài màn hình không bị đụng tới
+void renderObstacles(int c0, int c1, int r0, int r1) {
+    if (obstacleSprite < 0) return;
+    for (int cy = r0; cy <= r1; cy++) {
+        for (int chunkX = c0 >> CHUNK_SHIFT; chunkX <= c1 >> CHUNK_SHIFT; chunkX++) {
+            int base = chunkX << CHUNK_SHIFT;
+            int lo = std::max(c0, base) - base;
+            int hi = std::min(c1, base + CHUNK_SIZE - 1) - base;
+            unsigned long long bits = rowBits(world.obstacleBits, chunkX, cy) & (~0ULL << lo) & (~0ULL >> (63 - hi));
+            unsigned long long explosiveBits = rowBits(world.explosiveBits, chunkX, cy);
+            for (; bits != 0; bits &= bits - 1) {
+                int bit = __builtin_ctzll(bits);
+                SDL_Rect obstacleRect = {(base + bit) * CELL_SIZE, cy * CELL_SIZE, CELL_SIZE, CELL_SIZE};
+                toScreen(obstacleRect);
+                bool explosive = (explosiveBits >> bit) & 1;
+                drawSprite(obstacleSprite, obstacleRect, 0.0, explosive ? EXPLOSIVE_TINT : WHITE);
             }
         }
     }
 }
 
-// Di chuyển xe địch ngẫu nhiên (chỉ di chuyển nếu xe còn sống)
-void moveEnemies() {
-    Uint32 currentTime = SDL_GetTicks();
-    if (currentTime - lastMoveTime < MOVE_DELAY) return;
-    lastMoveTime = currentTime;
-
-    int directions[4][2] = {{0, -CELL_SIZE}, {0, CELL_SIZE}, {-CELL_SIZE, 0}, {CELL_SIZE, 0}};
-    double angles[4] = {0.0, 180.0, 270.0, 90.0};
-
-    for (int i = 0; i < ENEMY_COUNT; i++) {
-        if (!enemyAlive[i]) continue;
-        int randomDir = rand() % 4;
-        int dx = directions[randomDir][0];
-        int dy = directions[randomDir][1];
-        SDL_Rect newEnemyPos = {enemies[i].x + dx, enemies[i].y + dy, TANK_SIZE, TANK_SIZE};
-        if (newEnemyPos.x >= 0 && newEnemyPos.x + TANK_SIZE <= SCREEN_WIDTH &&
-            newEnemyPos.y >= 0 && newEnemyPos.y + TANK_SIZE <= SCREEN_HEIGHT) {
-            bool collision = false;
-            for (int j = 0; j < OBSTACLE_ROWS; j++) {
-                for (int k = 0; k < OBSTACLE_COLS; k++) {
-                    if (checkCollision(newEnemyPos, obstacles[j][k])) {
-                        collision = true;
-                        break;
-                    }
-                }
-                if (collision) break;
-            }
-            if (!collision) {
-                enemies[i] = newEnemyPos;
-                enemyAngles[i] = angles[randomDir];
+// Xếp ô (cx, cy) vào danh sách vẽ lại của texture địa hình: tô đen rồi vẽ chướng ngại vật nếu có
+void redrawTerrainCell(int cx, int cy) {
+    SDL_Rect rect = {(cx % TERRAIN_SPAN) * CELL_SIZE, (cy % TERRAIN_SPAN) * CELL_SIZE, CELL_SIZE, CELL_SIZE};
+    terrainClears.push_back(rect);
+    if (cx >= world.cols || cy >= world.rows || obstacleSprite < 0) return;
+    int cell = cellIndex(world, cx, cy);
+    if (!testCell(world.obstacleBits, cell)) return;
+    const AtlasSprite& region = atlas.sprites[obstacleSprite];
+    addSpriteUV(terrainBatch, rect, 0.0, testCell(world.explosiveBits, cell) ? EXPLOSIVE_TINT : WHITE,
+                region.u0, region.v0, region.u1, region.v1);
+}
+
+// Cập nhật texture địa hình để giữ đúng TERRAIN_SPAN x TERRAIN_SPAN ô bắt đầu từ (c0, r0).
+// Chỉ vẽ lại ô bị đổi và ô vừa vào vùng khi camera di chuyển; trả về số lệnh vẽ đã dùng.
+int updateTerrain(int c0, int r0) {
+    terrainClears.clear();
+    beginBatch(terrainBatch, atlas.texture);
+    if (!terrainValid || c0 != terrainCol || r0 != terrainRow) {
+        bool full = !terrainValid || abs(c0 - terrainCol) >= TERRAIN_SPAN || abs(r0 - terrainRow) >= TERRAIN_SPAN;
+        for (int cy = r0; cy < r0 + TERRAIN_SPAN; cy++) {
+            bool newRow = cy < terrainRow || cy >= terrainRow + TERRAIN_SPAN;
+            for (int cx = c0; cx < c0 + TERRAIN_SPAN; cx++) {
+                bool newCol = cx < terrainCol || cx >= terrainCol + TERRAIN_SPAN;
+                if (full || newRow || newCol) redrawTerrainCell(cx, cy);
             }
         }
     }
+    // Ô đổi nằm ngoài vùng thì bỏ qua: khi vào vùng nó sẽ được vẽ theo trạng thái mới
+    for (int cell : world.changedCells) {
+        int cx = cellX(world, cell), cy = cellY(world, cell);
+        if (cx >= c0 && cx < c0 + TERRAIN_SPAN && cy >= r0 && cy < r0 + TERRAIN_SPAN)
+            redrawTerrainCell(cx, cy);
+    }
+    world.changedCells.clear();
+    terrainCol = c0;
+    terrainRow = r0;
+    terrainValid = true;
+    if (terrainClears.empty()) return 0;
+
+    SDL_SetRenderTarget(renderer, terrainTexture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderFillRects(renderer, terrainClears.data(), terrainClears.size());
+    int calls = 1 + flushBatch(renderer, terrainBatch);
+    SDL_SetRenderTarget(renderer, nullptr);
+    return calls;
 }
 
-// Cập nhật vị trí các viên đạn và xử lý va chạm
-void updateBullets() {
-    for (int i = bullets.size() - 1; i >= 0; i--) {
-        Bullet &bullet = bullets[i];
-        bullet.rect.x += bullet.dx;
-        bullet.rect.y += bullet.dy;
-
-        bool removeBullet = false;
-        bool triggerExplosion = false; // Áp dụng cho đạn của người chơi lớn
-
-        // Nếu đạn ra khỏi màn hình, đánh dấu xóa; đối với đạn người chơi lớn thì kích hoạt vùng nổ
-        if (bullet.rect.x < 0 || bullet.rect.x + bullet.rect.w > SCREEN_WIDTH ||
-            bullet.rect.y < 0 || bullet.rect.y + bullet.rect.h > SCREEN_HEIGHT) {
-            if (!bullet.isEnemy && bullet.large)
-                triggerExplosion = true;
-            removeBullet = true;
+// Chép phần texture địa hình dưới camera ra cả màn hình bằng một lệnh vẽ. Chỗ cuộn vòng
+// của texture cắt màn hình thành tối đa 2 x 2 hình.
+int drawTerrain() {
+    beginBatch(terrainView, terrainTexture);
+    for (int sy = 0; sy < SCREEN_HEIGHT;) {
+        int ty = (cameraY + sy) % TERRAIN_PIXELS;
+        int h = std::min(SCREEN_HEIGHT - sy, TERRAIN_PIXELS - ty);
+        for (int sx = 0; sx < SCREEN_WIDTH;) {
+            int tx = (cameraX + sx) % TERRAIN_PIXELS;
+            int w = std::min(SCREEN_WIDTH - sx, TERRAIN_PIXELS - tx);
+            SDL_Rect dst = {sx, sy, w, h};
+            addSpriteUV(terrainView, dst, 0.0, WHITE, (float)tx / TERRAIN_PIXELS, (float)ty / TERRAIN_PIXELS,
+                        (float)(tx + w) / TERRAIN_PIXELS, (float)(ty + h) / TERRAIN_PIXELS);
+            sx += w;
         }
+        sy += h;
+    }
+    return flushBatch(renderer, terrainView);
+}
 
-        // Kiểm tra va chạm với chướng ngại vật (áp dụng cho tất cả đạn)
-        for (int r = 0; r < OBSTACLE_ROWS && !removeBullet; r++) {
-            for (int c = 0; c < OBSTACLE_COLS && !removeBullet; c++) {
-                if (obstacles[r][c].w > 0 && checkCollision(bullet.rect, obstacles[r][c])) {
-                    if (!bullet.isEnemy && bullet.large)
-                        triggerExplosion = true;
-                    obstacles[r][c].w = obstacles[r][c].h = 0;
-                    removeBullet = true;
-                    break;
-                }
+// Khung hình sắp vẽ có khác khung đã vẽ không. Khi tick cuối có vật di chuyển thì
+// vị trí vẽ còn đổi theo alpha nên phải vẽ mọi khung, rồi thêm một khung ở vị trí cuối;
+// ngoài ra chỉ vẽ khi world có thay đổi mới (đạn đang bay luôn là thay đổi).
+bool sceneChanged() {
+    return forceRedraw || drawnMoving || world.changes != drawnChanges || world.changes != changesBeforeTick;
+}
+
+// Vẽ bảng thời gian từng phần lên góc trên trái; trả về số lệnh vẽ đã dùng
+int drawProfileOverlay() {
+    const int margin = 8;
+    SDL_Rect panel = {margin, margin, OVERLAY_WIDTH + 2 * margin, PHASE_COUNT * OVERLAY_ROW + 2 * margin};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &panel);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    int calls = 1;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        const SDL_Color& color = PHASE_COLORS[phase];
+        int y = panel.y + margin + phase * OVERLAY_ROW;
+        int p50 = std::min((int)(profileStats[phase].p50 * OVERLAY_WIDTH / TICK_MS), OVERLAY_WIDTH);
+        int p99 = std::min((int)(profileStats[phase].p99 * OVERLAY_WIDTH / TICK_MS), OVERLAY_WIDTH);
+        // Ít nhất 1 pixel để phần nào cũng thấy màu của nó
+        SDL_Rect slow = {panel.x + margin, y + 2, std::max(p99, 1), OVERLAY_ROW - 4};
+        SDL_Rect typical = {panel.x + margin, y + 2, std::max(p50, 1), OVERLAY_ROW - 4};
+        SDL_SetRenderDrawColor(renderer, color.r / 2, color.g / 2, color.b / 2, 255);
+        SDL_RenderFillRect(renderer, &slow);
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+        SDL_RenderFillRect(renderer, &typical);
+        calls += 2;
+    }
+    return calls;
+}
+
+// Render: vẽ xe tăng, xe địch, chướng ngại vật và đạn nằm trong vùng camera.
+// Chướng ngại vật lấy từ texture địa hình vẽ sẵn (nằm dưới xe và đạn); mọi hình
+// còn lại được gom vào một lô theo thứ tự lớp như cũ rồi gửi bằng một lệnh.
+// alpha là phần tick đã trôi qua kể từ tick cuối, dùng để nội suy vị trí vẽ.
+void render(double alpha) {
+    ProfileScope drawScope(&profiler, PHASE_RENDER);
+    SDL_Rect tankRect = lerpRect(previousTank, world.tank, alpha);
+    if (world.playerAlive) updateCamera(tankRect);
+
+    // Các ô nằm trong màn hình
+    int c0 = cameraX / CELL_SIZE;
+    int r0 = cameraY / CELL_SIZE;
+    int c1 = std::min((cameraX + SCREEN_WIDTH - 1) / CELL_SIZE, world.cols - 1);
+    int r1 = std::min((cameraY + SCREEN_HEIGHT - 1) / CELL_SIZE, world.rows - 1);
+
+    // Texture địa hình phải cập nhật trước khi vẽ gì lên màn hình vì phải đổi texture đích
+    drawCalls = 0;
+    if (terrainTexture) drawCalls += updateTerrain(c0, r0);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    if (terrainTexture) drawCalls += drawTerrain();
+
+    beginBatch(sceneBatch, atlas.texture);
+
+    if (world.playerAlive && toScreen(tankRect))
+        drawSprite(tankSprite, tankRect, world.tankAngle, WHITE);
+
+    // Xe địch lấy theo ô qua enemyGrid, nới thêm một ô vì xe ở ô bên cạnh có thể
+    // đang trượt vào màn hình trong lúc nội suy
+    const EnemyStore& enemies = world.enemies;
+    for (int cy = std::max(r0 - 1, 0); cy <= std::min(r1 + 1, world.rows - 1) && enemySprite >= 0; cy++) {
+        for (int cx = std::max(c0 - 1, 0); cx <= std::min(c1 + 1, world.cols - 1); cx++) {
+            int cell = cellIndex(world, cx, cy);
+            for (int slot = firstInCell(world.enemyGrid, cell); slot != -1; slot = world.enemyGrid.nextInCell[slot]) {
+                int i = enemies.index[slot];
+                SDL_Rect rect = lerpRect(previousEnemies[slot], enemyRect(enemies, i), alpha);
+                if (toScreen(rect))
+                    drawSprite(enemySprite, rect, enemies.angle[i], WHITE);
             }
         }
+    }
 
-        if (!bullet.isEnemy) {
-            // Đạn của người chơi: nếu va chạm với xe địch thì tiêu diệt xe địch
-            for (int e = 0; e < ENEMY_COUNT && !removeBullet; e++) {
-                if (enemyAlive[e] && checkCollision(bullet.rect, enemies[e])) {
-                    enemyAlive[e] = false;
-                    enemies[e].w = enemies[e].h = 0;
-                    removeBullet = true;
-                    if (bullet.large)
-                        triggerExplosion = true;
-                    break;
-                }
-            }
+    if (!terrainTexture) renderObstacles(c0, c1, r0, r1);
+
+    // Vẽ đạn: đạn của xe địch luôn màu đỏ; đạn của người chơi nếu lớn thì màu đỏ, nếu nhỏ thì màu trắng.
+    const BulletPool& bullets = world.bullets;
+    for (int i = 0; i < bullets.count; i++) {
+        // Đạn đi thẳng đều nên vị trí tick trước là vị trí hiện tại trừ vận tốc
+        Rect current = bulletRect(bullets, i);
+        Rect previous = current;
+        previous.x -= bullets.dx[i] * world.tickMs / TICK_MS;
+        previous.y -= bullets.dy[i] * world.tickMs / TICK_MS;
+        SDL_Rect rect = lerpRect(previous, current, alpha);
+        if (!toScreen(rect)) continue;
+        // Nền màu của đạn (vùng trắng nhân màu) rồi tới ảnh đạn đè lên
+        drawSprite(whiteSprite, rect, 0.0, bullets.isEnemy[i] || bullets.large[i] ? RED : WHITE);
+
+        // *** Thêm phần vẽ ảnh đạn ở đây ***
+        if (bullets.large[i]) {
+            // Đạn 3x3 dùng ảnh "tenlua.png"
+            drawSprite(bulletLargeSprite, rect, 0.0, WHITE);
         } else {
-            // Đạn của xe địch: nếu va chạm với xe người chơi thì tiêu diệt người chơi
-            if (playerAlive && checkCollision(bullet.rect, tank)) {
-                playerAlive = false;
-                tank.w = tank.h = 0;
-                removeBullet = true;
-            }
-            // Nếu đạn của xe địch va chạm với bất kỳ xe địch nào khác thì chỉ xóa đạn
-            for (int e = 0; e < ENEMY_COUNT && !removeBullet; e++) {
-                if (enemyAlive[e] && checkCollision(bullet.rect, enemies[e])) {
-                    removeBullet = true;
-                    break;
-                }
-            }
+            // Đạn 1x1 dùng ảnh "dan.png"
+            drawSprite(bulletSmallSprite, rect, 0.0, WHITE);
         }
+    }
 
-        if (triggerExplosion && !bullet.isEnemy) {
-            int centerX = bullet.rect.x + bullet.rect.w / 2;
-            int centerY = bullet.rect.y + bullet.rect.h / 2;
-            SDL_Rect explosion;
-            explosion.w = 3 * CELL_SIZE;
-            explosion.h = 3 * CELL_SIZE;
-            explosion.x = centerX - explosion.w / 2;
-            explosion.y = centerY - explosion.h / 2;
-
-            for (int r = 0; r < OBSTACLE_ROWS; r++) {
-                for (int c = 0; c < OBSTACLE_COLS; c++) {
-                    if (obstacles[r][c].w > 0 && checkCollision(explosion, obstacles[r][c])) {
-                        obstacles[r][c].w = obstacles[r][c].h = 0;
-                    }
-                }
-            }
-            for (int e = 0; e < ENEMY_COUNT; e++) {
-                if (enemyAlive[e] && checkCollision(explosion, enemies[e])) {
-                    enemyAlive[e] = false;
-                    enemies[e].w = enemies[e].h = 0;
+    drawCalls += flushBatch(renderer, sceneBatch);
+    if (showProfile) drawCalls += drawProfileOverlay();
+    drawScope.stop();
+
+    ProfileScope presentScope(&profiler, PHASE_PRESENT);
+    SDL_RenderPresent(renderer);
+    drawnChanges = world.changes;
+    drawnMoving = world.changes != changesBeforeTick;
+    forceRedraw = false;
+}
+
+// Nạp ảnh ở luồng nền, chạy song song với việc tạo cửa sổ và renderer ở luồng chính.
+// Luồng nền chỉ làm phần không cần renderer (đọc gói hoặc giải mã PNG, xếp tập ảnh);
+// texture được tạo ở luồng chính (luồng vẽ) khi cả hai bên xong.
+// Các biến loaded* chỉ được đọc ở luồng chính sau khi assetsReady là true.
+const int IMAGE_COUNT = 5;
+Atlas loadedAtlas;                    // Bảng vùng, chưa có texture
+AssetPack loadedPack;                 // Gói đang mở nếu điểm ảnh lấy từ gói
+const void* loadedPixels = nullptr;   // Điểm ảnh của tấm ảnh chung, nullptr nếu nạp thất bại
+int loadedPitch = 0;
+Uint32 loadedFormat = 0;
+SDL_Surface* loadedSheet = nullptr;   // Tấm ảnh chung khi xếp từ PNG
+std::atomic<int> imagesLoaded(0);     // Tiến độ cho màn hình chờ, trên IMAGE_COUNT
+std::atomic<bool> assetsReady(false);
+double decodeMs = 0;                  // Thời gian luồng nền đã chạy
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Thân luồng nền. Có tainguyen.pak thì đọc bảng vùng và đọc trước các trang của gói
+// (không giải mã gì); không thì giải mã các PNG và xếp tập ảnh lúc chạy, kể cả 2 ảnh đạn
+// (dan.png: đạn 1x1, tenlua.png: đạn 3x3).
+void loadAssets() {
+    auto start = std::chrono::steady_clock::now();
+    const PackEntry* pixels = openPack(loadedPack, "tainguyen.pak") ? readAtlas(loadedAtlas, loadedPack) : nullptr;
+    if (pixels) {
+        touchPack(loadedPack);
+        loadedPixels = entryData(loadedPack, *pixels);
+        loadedPitch = pixels->pitch;
+        loadedFormat = pixels->format;
+        imagesLoaded = IMAGE_COUNT;
+    } else {
+        closePack(loadedPack);
+        const char* const imagePaths[IMAGE_COUNT] = {"tank.png", "tank2.png", "obstacle.png", "dan.png", "tenlua.png"};
+        const char* const imageNames[IMAGE_COUNT] = {"tank", "tank2", "obstacle", "dan", "tenlua"};
+        const bool directional[IMAGE_COUNT] = {true, true, false, false, false}; // Xe tăng chỉ quay 4 hướng: xoay sẵn lúc tải
+        SDL_Surface* images[IMAGE_COUNT] = {};
+        if (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) {
+            for (int i = 0; i < IMAGE_COUNT; i++) {
+                SDL_Surface* image = IMG_Load(imagePaths[i]);
+                if (image) {
+                    images[i] = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+                    SDL_FreeSurface(image);
                 }
-            }
-            if (checkCollision(tank, explosion)) {
-                playerAlive = false;
-                tank.w = tank.h = 0;
+                imagesLoaded++;
             }
         }
-
-        if (removeBullet) {
-            bullets.erase(bullets.begin() + i);
+        loadedSheet = packAtlas(loadedAtlas, images, imageNames, IMAGE_COUNT, directional);
+        for (SDL_Surface* image : images)
+            SDL_FreeSurface(image);
+        if (loadedSheet) {
+            loadedPixels = loadedSheet->pixels;
+            loadedPitch = loadedSheet->pitch;
+            loadedFormat = loadedSheet->format->format;
         }
     }
+    decodeMs = millisecondsSince(start);
+    assetsReady = true;
 }
 
-// Render: vẽ xe tăng, xe địch, chướng ngại vật và đạn
-void render() {
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-
-    if (playerAlive && tankTexture)
-        SDL_RenderCopyEx(renderer, tankTexture, nullptr, &tank, tankAngle, nullptr, SDL_FLIP_NONE);
-
-    for (int i = 0; i < ENEMY_COUNT; i++) {
-        if (enemyAlive[i] && enemyTexture)
-            SDL_RenderCopyEx(renderer, enemyTexture, nullptr, &enemies[i], enemyAngles[i], nullptr, SDL_FLIP_NONE);
+// Màn hình chờ khi luồng nền chưa xong lúc cửa sổ đã sẵn sàng: thanh tiến độ theo số
+// ảnh đã nạp. Trả về false nếu người chơi đóng cửa sổ trong lúc chờ.
+bool waitForAssets() {
+    if (!assetsReady) SDL_SetWindowTitle(window, "Battle City - dang nap...");
+    while (!assetsReady) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) return false;
+        }
+        SDL_Rect frame = {SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 10, SCREEN_WIDTH / 2, 20};
+        SDL_Rect bar = {frame.x + 2, frame.y + 2, (frame.w - 4) * imagesLoaded / IMAGE_COUNT, frame.h - 4};
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawRect(renderer, &frame);
+        SDL_RenderFillRect(renderer, &bar);
+        SDL_RenderPresent(renderer);
+        SDL_Delay(16);
     }
+    SDL_SetWindowTitle(window, "Battle City");
+    return true;
+}
 
-    for (int i = 0; i < OBSTACLE_ROWS; i++) {
-        for (int j = 0; j < OBSTACLE_COLS; j++) {
-            if (obstacleTexture && obstacles[i][j].w > 0)
-                SDL_RenderCopy(renderer, obstacleTexture, nullptr, &obstacles[i][j]);
+// Tạo texture tập ảnh từ kết quả của luồng nền (ở luồng vẽ), rồi bỏ các bản trong RAM
+void uploadAssets() {
+    atlas = loadedAtlas;
+    if (!loadedPixels || !createAtlasTexture(renderer, atlas, loadedPixels, loadedPitch, loadedFormat))
+        destroyAtlas(atlas);
+    SDL_FreeSurface(loadedSheet);
+    loadedSheet = nullptr;
+    closePack(loadedPack); // Texture đã nằm trên GPU, không cần giữ ánh xạ
+    loadedPixels = nullptr;
+
+    tankSprite = findSprite(atlas, "tank");
+    enemySprite = findSprite(atlas, "tank2");
+    obstacleSprite = findSprite(atlas, "obstacle");
+    bulletSmallSprite = findSprite(atlas, "dan");
+    bulletLargeSprite = findSprite(atlas, "tenlua");
+    whiteSprite = findSprite(atlas, ATLAS_WHITE);
+}
+
+// Mã băm FNV-1a của điểm ảnh một khung (bỏ phần đệm cuối mỗi hàng)
+unsigned long long hashFrame(const SDL_Surface* surface) {
+    unsigned long long hash = 14695981039346656037ULL;
+    int rowBytes = surface->w * surface->format->BytesPerPixel;
+    for (int y = 0; y < surface->h; y++) {
+        const unsigned char* row = (const unsigned char*)surface->pixels + y * surface->pitch;
+        for (int x = 0; x < rowBytes; x++) {
+            hash ^= row[x];
+            hash *= 1099511628211ULL;
         }
     }
+    return hash;
+}
 
-    // Vẽ đạn: đạn của xe địch luôn màu đỏ; đạn của người chơi nếu lớn thì màu đỏ, nếu nhỏ thì màu trắng.
-    for (const auto& bullet : bullets) {
-        if (bullet.isEnemy)
-            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-        else {
-            if (bullet.large)
-                SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-            else
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+// Chế độ không cửa sổ cho máy đo và CI không có màn hình hay GPU: renderer phần mềm của
+// SDL vẽ vào một surface trong RAM (không cần video driver nào), phát lại trận đã ghi và
+// vẽ sau mỗi tick với alpha = 1, nên cùng file replay luôn cho đúng các khung hình đó.
+// hashFrames: in mã băm điểm ảnh của từng khung và mã băm gộp, để so hai bản build.
+// tracePath khác nullptr: ghi thời gian từng phần của các tick cuối ra file trace.
+int runHeadless(const char* path, bool hashFrames, const char* tracePath) {
+    Replay recorded;
+    if (!loadReplay(recorded, path)) {
+        std::cout << "Không đọc được file " << path << std::endl;
+        return 1;
+    }
+    SDL_Surface* screen = SDL_Init(0) == 0 ? SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32,
+                                                                            SDL_PIXELFORMAT_ARGB8888) : nullptr;
+    renderer = screen ? SDL_CreateSoftwareRenderer(screen) : nullptr;
+    if (!renderer) {
+        std::cout << "Không tạo được renderer phần mềm: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(screen);
+        close();
+        return -1;
+    }
+    loadAssets();
+    uploadAssets();
+    createTerrain();
+
+    if (recorded.mapCols > 0)
+        initWorld(world, recorded.mapCols, recorded.mapRows, recorded.mapEnemies, recorded.seed);
+    else
+        initWorld(world, recorded.seed);
+    world.tickMs = recorded.tickMs;
+    savePreviousPositions();
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 renderCounts = 0, worstCounts = 0;
+    long long totalDrawCalls = 0;
+    unsigned long long combined = 14695981039346656037ULL;
+    size_t next = 0;
+    while (world.tick < recorded.finalTick) {
+        while (next < recorded.events.size() && recorded.events[next].tick == world.tick)
+            pendingInputs.push_back(recorded.events[next++].input);
+        tickWorld();
+
+        Uint64 renderStart = SDL_GetPerformanceCounter();
+        render(1.0);
+        Uint64 counts = SDL_GetPerformanceCounter() - renderStart;
+        renderCounts += counts;
+        worstCounts = std::max(worstCounts, counts);
+        totalDrawCalls += drawCalls;
+
+        if (hashFrames) {
+            unsigned long long hash = hashFrame(screen);
+            printf("%u %016llx\n", world.tick, hash);
+            combined = (combined ^ hash) * 1099511628211ULL;
         }
-        SDL_RenderFillRect(renderer, &bullet.rect);
+    }
 
-        // *** Thêm phần vẽ ảnh đạn ở đây ***
-        if (bullet.large) {
-            // Đạn 3x3 dùng ảnh "tenlua.png"
-            if (bulletTextureLarge) {
-                SDL_RenderCopy(renderer, bulletTextureLarge, nullptr, &bullet.rect);
-            }
-        } else {
-            // Đạn 1x1 dùng ảnh "dan.png"
-            if (bulletTextureSmall) {
-                SDL_RenderCopy(renderer, bulletTextureSmall, nullptr, &bullet.rect);
-            }
-        }
+    long long frames = world.tick;
+    double renderMs = renderCounts * 1000.0 / frequency;
+    std::cout << "Đã vẽ " << frames << " khung " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT << " bằng renderer phần mềm: "
+              << (frames > 0 ? renderMs / frames : 0.0) << " ms/khung (chậm nhất " << worstCounts * 1000.0 / frequency
+              << " ms), " << (frames > 0 ? (double)totalDrawCalls / frames : 0.0) << " lệnh vẽ/khung" << std::endl;
+    if (hashFrames) printf("ma bam gop: %016llx\n", combined);
+    copyProfileSamples(profiler, profileSamples);
+    computePhaseStats(profileSamples, 0, profileStats);
+    for (int phase = PHASE_MOVE_ENEMIES; phase < PHASE_COUNT; phase++) {
+        const PhaseStats& stats = profileStats[phase];
+        printf("%-14s p50 %.3f  p95 %.3f  p99 %.3f  max %.3f ms (%d mau)\n", PHASE_NAMES[phase], stats.p50, stats.p95,
+               stats.p99, stats.max, stats.count);
     }
+    if (tracePath && !writeChromeTrace(profileSamples, tracePath))
+        std::cout << "Không ghi được file " << tracePath << std::endl;
+    bool matched = hashWorld(world) == recorded.finalHash;
+    std::cout << (matched ? "Trạng thái cuối khớp file replay" : "Trạng thái cuối KHÔNG khớp file replay") << std::endl;
 
-    SDL_RenderPresent(renderer);
+    close();
+    SDL_FreeSurface(screen);
+    return matched ? 0 : 1;
 }
 
 int main(int argc, char* argv[]) {
-    if (!init()) return -1;
-    srand(time(nullptr));
-
-    tankTexture = loadTexture("tank.png");
-    enemyTexture = loadTexture("tank2.png");
-    obstacleTexture = loadTexture("obstacle.png");
+    // Đo từng phần luôn bật: chỉ tốn vài chục ns mỗi phần
+    profiler.enabled = true;
+    world.profiler = &profiler;
+    if (argc > 2 && strcmp(argv[1], "--headless") == 0) {
+        bool hashFrames = false;
+        const char* tracePath = nullptr;
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "--hash") == 0) hashFrames = true;
+            else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        }
+        return runHeadless(argv[2], hashFrames, tracePath);
+    }
 
-    // *** Tải thêm 2 file ảnh đạn ***
-    bulletTextureSmall = loadTexture("dan.png");    // đạn 1x1
-    bulletTextureLarge = loadTexture("tenlua.png"); // đạn 3x3
+    bool serial = argc > 1 && strcmp(argv[1], "--serial") == 0;
+    if (serial) {
+        argc--;
+        argv++;
+    }
 
-    setupObstacles();
+    // Bắt đầu giải mã ảnh trước khi tạo cửa sổ (--serial: sau khi tạo cửa sổ, ở luồng chính);
+    // thời gian tới khung hình đầu tiên tính từ đây
+    auto startTime = std::chrono::steady_clock::now();
+    std::thread loader;
+    if (!serial) loader = std::thread(loadAssets);
+    bool initialized = init();
+    double initMs = millisecondsSince(startTime);
+    if (serial && initialized) loadAssets();
+    if (!initialized || !waitForAssets()) {
+        if (loader.joinable()) loader.join();
+        SDL_FreeSurface(loadedSheet);
+        closePack(loadedPack);
+        close();
+        return initialized ? 0 : -1;
+    }
+    if (loader.joinable()) loader.join();
+    double waitMs = millisecondsSince(startTime) - initMs;
+    unsigned int seed = (unsigned int)time(nullptr);
+
+    uploadAssets();
+    createTerrain();
+
+    startReplay(replay, seed, TICK_MS);
+    if (argc > 3 && validMap(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]))) {
+        replay.mapCols = atoi(argv[1]);
+        replay.mapRows = atoi(argv[2]);
+        replay.mapEnemies = atoi(argv[3]);
+        initWorld(world, replay.mapCols, replay.mapRows, replay.mapEnemies, seed);
+    } else {
+        if (argc > 3) std::cout << "Bản đồ không hợp lệ, dùng bản đồ mặc định" << std::endl;
+        initWorld(world, seed);
+    }
+    savePreviousPositions();
+
+    // Vòng lặp bước cố định: mô phỏng luôn chạy đúng TICK_MS mỗi tick theo đồng hồ
+    // SDL_GetPerformanceCounter, tách khỏi tốc độ vẽ. Khung hình chậm thì chạy bù
+    // nhiều tick, máy nhanh thì chỉ vẽ lại (nội suy) chứ không mô phỏng thêm.
+    SDL_RendererInfo rendererInfo;
+    bool vsync = SDL_GetRendererInfo(renderer, &rendererInfo) == 0 &&
+                 (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC);
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 tickCounts = frequency * TICK_MS / 1000;
+    const Uint64 maxFrameCounts = frequency / 4; // Bỏ bớt khi bị treo lâu, tránh chạy bù mãi không kịp
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    Uint64 accumulator = 0;
+
+    // Thống kê vẽ, hiện trên thanh tiêu đề mỗi giây
+    Uint64 statsStart = previousCounter;
+    Uint64 renderCounts = 0;
+    int frames = 0;
+    int skippedFrames = 0;
+    // Tổng cả trận, in ra khi thoát
+    long long totalFrames = 0, totalSkipped = 0;
 
     bool running = true;
     SDL_Event event;
     while (running) {
+        ProfileScope inputScope(&profiler, PHASE_INPUT);
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT)
                 running = false;
+            // Texture đích có thể mất nội dung (ví dụ Direct3D khi đổi cửa sổ): vẽ lại cả lớp địa hình
+            if (event.type == SDL_RENDER_TARGETS_RESET)
+                terrainValid = false;
+            // Nội dung cửa sổ có thể đã mất, không dựa vào khung trước được
+            if (event.type == SDL_WINDOWEVENT || event.type == SDL_RENDER_TARGETS_RESET)
+                forceRedraw = true;
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+                showProfile = !showProfile;
+                forceRedraw = true;
+            }
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F4) {
+                copyProfileSamples(profiler, profileSamples);
+                if (!writeChromeTrace(profileSamples, "hieunang.json"))
+                    std::cout << "Không ghi được file hieunang.json" << std::endl;
+            }
             handleInput(event);
         }
-        moveEnemies();
-        enemyShoot();  // Mỗi 1 giây, các xe địch bắn đạn ngẫu nhiên
-        updateBullets();
-        render();
+        inputScope.stop();
 
-        // Kết thúc game nếu người chơi chết hoặc tất cả xe địch chết
-        bool allEnemiesDead = true;
-        for (int i = 0; i < ENEMY_COUNT; i++) {
-            if (enemyAlive[i]) {
-                allEnemiesDead = false;
-                break;
+        Uint64 now = SDL_GetPerformanceCounter();
+        Uint64 frameCounts = now - previousCounter;
+        previousCounter = now;
+        accumulator += frameCounts < maxFrameCounts ? frameCounts : maxFrameCounts;
+
+        while (accumulator >= tickCounts && !isGameOver(world)) {
+            tickWorld();
+            accumulator -= tickCounts;
+        }
+        // Không có gì đổi thì bỏ qua cả render() lẫn SDL_RenderPresent: màn hình vẫn giữ
+        // khung cũ. Không thể chỉ present lại vì SDL không giữ nội dung bộ đệm sau.
+        bool drawn = sceneChanged();
+        if (drawn) {
+            Uint64 renderStart = SDL_GetPerformanceCounter();
+            render((double)accumulator / tickCounts);
+            renderCounts += SDL_GetPerformanceCounter() - renderStart;
+            frames++;
+            totalFrames++;
+            if (totalFrames == 1) {
+                // Đo thật cả hai cách: chạy thường (luồng nền) và chạy với --serial rồi so hai số
+                double firstFrameMs = millisecondsSince(startTime);
+                std::cout << "Khung hình đầu tiên sau " << firstFrameMs << " ms, "
+                          << (serial ? "nạp tuần tự" : "nạp ở luồng nền") << " (tạo cửa sổ " << initMs
+                          << " ms, nạp ảnh " << decodeMs << " ms, chờ sau khi tạo cửa sổ " << waitMs << " ms)"
+                          << std::endl;
             }
+        } else {
+            skippedFrames++;
+            totalSkipped++;
         }
-        if (!playerAlive || allEnemiesDead)
+        if (now - statsStart >= frequency) {
+            char title[320];
+            if (showProfile) {
+                // p50/p99 (ms) của từng phần trong giây vừa qua, cùng thứ tự với các hàng của bảng
+                copyProfileSamples(profiler, profileSamples);
+                computePhaseStats(profileSamples, profileNow(profiler) - 1000000000LL, profileStats);
+                int length = snprintf(title, sizeof(title), "Battle City - p50/p99 ms:");
+                for (int phase = 0; phase < PHASE_COUNT && length < (int)sizeof(title); phase++) {
+                    length += snprintf(title + length, sizeof(title) - length, " %s %.2f/%.2f", PHASE_NAMES[phase],
+                                       profileStats[phase].p50, profileStats[phase].p99);
+                }
+                forceRedraw = true; // Vẽ lại bảng với số liệu mới
+            } else {
+                snprintf(title, sizeof(title), "Battle City - %d lenh ve, %.2f ms ve/khung, %d khung ve/giay, %d khung bo qua",
+                         drawCalls, frames > 0 ? renderCounts * 1000.0 / frequency / frames : 0.0, frames, skippedFrames);
+            }
+            SDL_SetWindowTitle(window, title);
+            statsStart = now;
+            renderCounts = 0;
+            frames = 0;
+            skippedFrames = 0;
+        }
+
+        // Kết thúc game nếu người chơi chết hoặc tất cả xe địch chết
+        if (isGameOver(world))
             running = false;
 
-        SDL_Delay(16); // ~60 FPS
+        // Bỏ qua khung thì không có vsync chặn lại: ngủ tới tick kế tiếp, vì trước đó
+        // không có gì để vẽ (phím bấm cũng chỉ áp dụng ở đầu tick). Không có vsync thì
+        // nhường CPU một chút thay vì vẽ liên tục.
+        if (!drawn) {
+            Uint64 waitMs = accumulator < tickCounts ? (tickCounts - accumulator) * 1000 / frequency : 0;
+            SDL_Delay(waitMs > 1 ? (Uint32)waitMs : 1);
+        } else if (!vsync) {
+            SDL_Delay(1);
+        }
     }
+    std::cout << "Đã vẽ " << totalFrames << " khung, bỏ qua " << totalSkipped << " khung" << std::endl;
+
+    finishReplay(replay, world);
+    if (!saveReplay(replay, "tran_cuoi.rep"))
+        std::cout << "Không ghi được file tran_cuoi.rep" << std::endl;
 
     close();
     return 0;
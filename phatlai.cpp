@@ -0,0 +1,182 @@
+#include "phatlai.h"
+#include <cstdio>
+#include <cstring>
+
+static const char REPLAY_MAGIC[4] = {'B', 'C', 'R', 'P'};
+static const unsigned int REPLAY_VERSION = 6; // 6: đạn cộng dồn phần lẻ quãng đường mỗi tick
+
+void startReplay(Replay& replay, unsigned int seed, int tickMs) {
+    replay.seed = seed;
+    replay.tickMs = tickMs;
+    replay.mapCols = replay.mapRows = replay.mapEnemies = 0;
+    replay.finalTick = 0;
+    replay.finalHash = 0;
+    replay.events.clear();
+}
+
+void recordInput(Replay& replay, unsigned int tick, const Input& input) {
+    ReplayEvent event = {tick, input};
+    replay.events.push_back(event);
+}
+
+void finishReplay(Replay& replay, const World& world) {
+    replay.finalTick = world.tick;
+    replay.finalHash = hashWorld(world);
+}
+
+// Phím bấm gói vào một byte: 3 bit hướng, 1 bit đạn nhỏ, 1 bit đạn lớn
+static unsigned int packInput(const Input& input) {
+    return input.move | (input.shootSmall << 3) | (input.shootLarge << 4);
+}
+
+static Input unpackInput(unsigned int packed) {
+    Input input = {(int)(packed & 7), (packed >> 3 & 1) != 0, (packed >> 4 & 1) != 0};
+    return input;
+}
+
+static void writeVarint(std::vector<unsigned char>& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+static bool readVarint(const std::vector<unsigned char>& in, size_t& pos, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        unsigned char byte = in[pos++];
+        value |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool saveReplay(const Replay& replay, const char* path) {
+    std::vector<unsigned char> out(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    writeVarint(out, REPLAY_VERSION);
+    writeVarint(out, replay.seed);
+    writeVarint(out, replay.tickMs);
+    writeVarint(out, replay.mapCols);
+    writeVarint(out, replay.mapRows);
+    writeVarint(out, replay.mapEnemies);
+    writeVarint(out, replay.finalTick);
+    writeVarint(out, replay.finalHash);
+    writeVarint(out, replay.events.size());
+    unsigned int lastTick = 0;
+    for (const ReplayEvent& event : replay.events) {
+        writeVarint(out, event.tick - lastTick);
+        writeVarint(out, packInput(event.input));
+        lastTick = event.tick;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    fclose(file);
+    return ok;
+}
+
+bool loadReplay(Replay& replay, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    std::vector<unsigned char> in;
+    unsigned char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        in.insert(in.end(), buffer, buffer + n);
+    fclose(file);
+
+    if (in.size() < 4 || memcmp(in.data(), REPLAY_MAGIC, 4) != 0) return false;
+    size_t pos = 4;
+    unsigned long long version, seed, tickMs, mapCols, mapRows, mapEnemies, finalTick, finalHash, eventCount;
+    if (!readVarint(in, pos, version) || version != REPLAY_VERSION) return false;
+    if (!readVarint(in, pos, seed) || !readVarint(in, pos, tickMs) ||
+        !readVarint(in, pos, mapCols) || !readVarint(in, pos, mapRows) || !readVarint(in, pos, mapEnemies) ||
+        !readVarint(in, pos, finalTick) || !readVarint(in, pos, finalHash) ||
+        !readVarint(in, pos, eventCount))
+        return false;
+    // File hỏng hoặc cố ý sửa không được làm initWorld cấp phát quá lớn hay làm mô phỏng đứng
+    if (tickMs < 1 || tickMs > (unsigned long long)MAX_TICK_MS) return false;
+    if (mapCols > (unsigned long long)MAX_MAP_SIDE || mapRows > (unsigned long long)MAX_MAP_SIDE ||
+        mapEnemies > (unsigned long long)MAX_MAP_SIDE * MAX_MAP_SIDE)
+        return false;
+    if (mapCols > 0 && !validMap((int)mapCols, (int)mapRows, (int)mapEnemies)) return false;
+    if (finalTick > (unsigned long long)MAX_REPLAY_TICKS) return false;
+
+    startReplay(replay, (unsigned int)seed, (int)tickMs);
+    replay.mapCols = (int)mapCols;
+    replay.mapRows = (int)mapRows;
+    replay.mapEnemies = (int)mapEnemies;
+    replay.finalTick = (unsigned int)finalTick;
+    replay.finalHash = finalHash;
+    unsigned int tick = 0;
+    for (unsigned long long i = 0; i < eventCount; i++) {
+        unsigned long long delta, packed;
+        if (!readVarint(in, pos, delta) || !readVarint(in, pos, packed)) return false;
+        // Phím sau tick cuối không bao giờ được áp dụng: file hỏng
+        if (delta > finalTick - tick) return false;
+        tick += (unsigned int)delta;
+        recordInput(replay, tick, unpackInput((unsigned int)packed));
+    }
+    return true;
+}
+
+static void hashBytes(unsigned long long& hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+template <typename T>
+static void hashVector(unsigned long long& hash, const std::vector<T>& values, size_t count) {
+    if (count > 0) hashBytes(hash, values.data(), count * sizeof(T));
+}
+
+unsigned long long hashWorld(const World& world) {
+    unsigned long long hash = 14695981039346656037ULL;
+    hashBytes(hash, &world.tick, sizeof(world.tick));
+    hashBytes(hash, world.rng.s, sizeof(world.rng.s));
+    hashBytes(hash, &world.tank, sizeof(world.tank));
+    hashBytes(hash, &world.playerAlive, sizeof(world.playerAlive));
+    hashBytes(hash, &world.tankAngle, sizeof(world.tankAngle));
+    const EnemyStore& enemies = world.enemies;
+    hashVector(hash, enemies.x, enemies.count);
+    hashVector(hash, enemies.y, enemies.count);
+    hashVector(hash, enemies.angle, enemies.count);
+    hashVector(hash, enemies.nextMove, enemies.count);
+    hashVector(hash, enemies.nextShoot, enemies.count);
+    hashVector(hash, enemies.slot, enemies.count);
+    hashVector(hash, world.obstacleBits.chunkOffset, world.obstacleBits.chunkOffset.size());
+    hashVector(hash, world.obstacleBits.words, world.obstacleBits.words.size());
+    hashVector(hash, world.explosiveBits.chunkOffset, world.explosiveBits.chunkOffset.size());
+    hashVector(hash, world.explosiveBits.words, world.explosiveBits.words.size());
+    const BulletPool& pool = world.bullets;
+    hashVector(hash, pool.x, pool.count);
+    hashVector(hash, pool.y, pool.count);
+    hashVector(hash, pool.dx, pool.count);
+    hashVector(hash, pool.dy, pool.count);
+    hashVector(hash, pool.remX, pool.count);
+    hashVector(hash, pool.remY, pool.count);
+    hashVector(hash, pool.large, pool.count);
+    hashVector(hash, pool.isEnemy, pool.count);
+    return hash;
+}
+
+bool playReplay(const Replay& replay, World& world) {
+    if (replay.mapCols > 0)
+        initWorld(world, replay.mapCols, replay.mapRows, replay.mapEnemies, replay.seed);
+    else
+        initWorld(world, replay.seed);
+    world.tickMs = replay.tickMs;
+    size_t next = 0;
+    while (world.tick < replay.finalTick) {
+        while (next < replay.events.size() && replay.events[next].tick == world.tick)
+            applyInput(world, replay.events[next++].input);
+        updateWorld(world);
+    }
+    return hashWorld(world) == replay.finalHash;
+}
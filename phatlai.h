@@ -0,0 +1,37 @@
+#pragma once
+// Ghi lại và phát lại trận đấu của ngay4.
+// File replay gồm seed, độ dài tick, kích thước bản đồ và các phím bấm kèm số tick; số tick được
+// lưu dạng chênh lệch so với phím trước, mọi số nguyên mã hóa varint (LEB128)
+// nên một trận vài phút chỉ tốn vài KB. Cuối trận lưu mã băm trạng thái World
+// để khi phát lại kiểm tra mô phỏng còn cho đúng kết quả cũ.
+#include "mophong.h"
+#include <vector>
+
+struct ReplayEvent {
+    unsigned int tick; // Tick mà phím được áp dụng (trước updateWorld của tick đó)
+    Input input;
+};
+
+struct Replay {
+    unsigned int seed;
+    int tickMs;
+    int mapCols, mapRows, mapEnemies; // Bản đồ initWorld(cols, rows, enemies); mapCols = 0 là bản đồ mặc định
+    unsigned int finalTick;
+    unsigned long long finalHash;
+    std::vector<ReplayEvent> events;
+};
+
+// Bắt đầu ghi trên bản đồ mặc định: lưu seed và độ dài tick, xóa các phím cũ
+void startReplay(Replay& replay, unsigned int seed, int tickMs);
+void recordInput(Replay& replay, unsigned int tick, const Input& input);
+// Chốt trận: lưu tick cuối và mã băm trạng thái
+void finishReplay(Replay& replay, const World& world);
+
+bool saveReplay(const Replay& replay, const char* path);
+bool loadReplay(Replay& replay, const char* path);
+
+// Mã băm FNV-1a của toàn bộ trạng thái mô phỏng
+unsigned long long hashWorld(const World& world);
+
+// Mô phỏng lại trận từ đầu nhanh nhất có thể; trả về true nếu trạng thái cuối khớp finalHash
+bool playReplay(const Replay& replay, World& world);
@@ -0,0 +1,267 @@
+#include "tapanh.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const char* const ATLAS_WHITE = "trang";
+const char* const ATLAS_PACK_NAME = "tapanh";
+
+const int ATLAS_PADDING = 2;    // Khoảng trống giữa các ảnh để lọc texture không lấn sang ảnh bên cạnh
+const int ATLAS_MAX_SIZE = 4096;
+const int WHITE_SIZE = 4;
+
+// Xếp theo kệ: ảnh cao trước, lần lượt từ trái sang phải, hết chỗ thì xuống kệ mới.
+// Trả về false nếu không vừa chiều rộng width; height là chiều cao cần dùng.
+static bool packShelves(std::vector<AtlasSprite>& sprites, int width, int& height) {
+    std::vector<int> order(sprites.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return sprites[a].rect.h > sprites[b].rect.h; });
+
+    int x = ATLAS_PADDING, y = ATLAS_PADDING, shelfHeight = 0;
+    for (int i : order) {
+        SDL_Rect& rect = sprites[i].rect;
+        if (rect.w + 2 * ATLAS_PADDING > width) return false;
+        if (x + rect.w + ATLAS_PADDING > width) {
+            y += shelfHeight + ATLAS_PADDING;
+            x = ATLAS_PADDING;
+            shelfHeight = 0;
+        }
+        rect.x = x;
+        rect.y = y;
+        x += rect.w + ATLAS_PADDING;
+        shelfHeight = std::max(shelfHeight, rect.h);
+    }
+    height = y + shelfHeight + ATLAS_PADDING;
+    return true;
+}
+
+// Bản sao của ảnh RGBA32 source xoay turns lần 90 độ theo chiều kim đồng hồ (cùng chiều
+// với góc của SDL_RenderCopyEx); chỉ chép điểm ảnh nên không bị mờ như khi xoay lúc vẽ
+static SDL_Surface* rotateSurface(SDL_Surface* source, int turns) {
+    int w = source->w, h = source->h;
+    bool swap = turns % 2 == 1;
+    SDL_Surface* rotated = SDL_CreateRGBSurfaceWithFormat(0, swap ? h : w, swap ? w : h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!rotated) return nullptr;
+    for (int y = 0; y < h; y++) {
+        const Uint32* row = (const Uint32*)((const Uint8*)source->pixels + y * source->pitch);
+        for (int x = 0; x < w; x++) {
+            // Điểm (x, y) của ảnh gốc rơi vào (dx, dy) của ảnh xoay
+            int dx = x, dy = y;
+            if (turns == 1)      { dx = h - 1 - y; dy = x; }
+            else if (turns == 2) { dx = w - 1 - x; dy = h - 1 - y; }
+            else if (turns == 3) { dx = y;         dy = w - 1 - x; }
+            ((Uint32*)((Uint8*)rotated->pixels + dy * rotated->pitch))[dx] = row[x];
+        }
+    }
+    return rotated;
+}
+
+static void addRegion(Atlas& atlas, std::vector<SDL_Surface*>& surfaces, const std::string& name, SDL_Surface* surface) {
+    AtlasSprite sprite;
+    sprite.name = name;
+    sprite.rect = {0, 0, surface ? surface->w : WHITE_SIZE, surface ? surface->h : WHITE_SIZE};
+    for (int turns = 0; turns < 4; turns++)
+        sprite.turned[turns] = -1;
+    sprite.turned[0] = atlas.sprites.size();
+    atlas.sprites.push_back(sprite);
+    surfaces.push_back(surface);
+}
+
+// Tọa độ texture của mọi vùng theo atlas.width x atlas.height
+static void computeUV(Atlas& atlas) {
+    for (AtlasSprite& sprite : atlas.sprites) {
+        sprite.u0 = (float)sprite.rect.x / atlas.width;
+        sprite.v0 = (float)sprite.rect.y / atlas.height;
+        sprite.u1 = (float)(sprite.rect.x + sprite.rect.w) / atlas.width;
+        sprite.v1 = (float)(sprite.rect.y + sprite.rect.h) / atlas.height;
+        // Vùng trắng chỉ lấy phần giữa, để lọc tuyến tính không lẫn viền trong suốt xung quanh
+        if (sprite.name == ATLAS_WHITE) {
+            sprite.u0 = (sprite.rect.x + 1.0f) / atlas.width;
+            sprite.v0 = (sprite.rect.y + 1.0f) / atlas.height;
+            sprite.u1 = (sprite.rect.x + sprite.rect.w - 1.0f) / atlas.width;
+            sprite.v1 = (sprite.rect.y + sprite.rect.h - 1.0f) / atlas.height;
+        }
+    }
+}
+
+SDL_Surface* packAtlas(Atlas& atlas, SDL_Surface* const* images, const char* const* names, int count,
+                       const bool* directional) {
+    destroyAtlas(atlas);
+
+    std::vector<SDL_Surface*> surfaces; // Cùng thứ tự với atlas.sprites, nullptr cho vùng trắng
+    std::vector<bool> owned;            // Bản xoay do hàm này tạo ra, phải giải phóng
+    for (int i = 0; i < count; i++) {
+        SDL_Surface* image = images[i];
+        if (!image) continue;
+        int original = atlas.sprites.size();
+        addRegion(atlas, surfaces, names[i], image);
+        owned.push_back(false);
+        if (!directional || !directional[i]) continue;
+        // Ba bản xoay dùng chung bảng turned với ảnh gốc
+        for (int turns = 1; turns < 4; turns++) {
+            SDL_Surface* rotated = rotateSurface(image, turns);
+            if (!rotated) continue;
+            atlas.sprites[original].turned[turns] = atlas.sprites.size();
+            addRegion(atlas, surfaces, std::string(names[i]) + "@" + std::to_string(turns * 90), rotated);
+            owned.push_back(true);
+        }
+        for (int turns = 1; turns < 4; turns++) {
+            int variant = atlas.sprites[original].turned[turns];
+            if (variant < 0) continue;
+            for (int k = 0; k < 4; k++)
+                atlas.sprites[variant].turned[k] = atlas.sprites[original].turned[(turns + k) % 4];
+        }
+    }
+    addRegion(atlas, surfaces, ATLAS_WHITE, nullptr);
+    owned.push_back(false);
+
+    // Chiều rộng lũy thừa của 2 nhỏ nhất mà tập ảnh không cao hơn rộng
+    int width = 64, height = 0;
+    while (width <= ATLAS_MAX_SIZE && (!packShelves(atlas.sprites, width, height) || height > width))
+        width *= 2;
+
+    SDL_Surface* sheet = width <= ATLAS_MAX_SIZE ? SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32) : nullptr;
+    if (sheet) {
+        SDL_FillRect(sheet, nullptr, 0); // Trong suốt
+        for (int i = 0; i < (int)atlas.sprites.size(); i++) {
+            SDL_Rect rect = atlas.sprites[i].rect;
+            if (surfaces[i]) {
+                SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE); // Chép nguyên điểm ảnh, kể cả kênh alpha
+                SDL_BlitSurface(surfaces[i], nullptr, sheet, &rect);
+            } else {
+                SDL_FillRect(sheet, &rect, 0xFFFFFFFF);
+            }
+        }
+        atlas.width = width;
+        atlas.height = height;
+        computeUV(atlas);
+    } else {
+        atlas.sprites.clear();
+    }
+    for (int i = 0; i < (int)surfaces.size(); i++) {
+        if (owned[i]) SDL_FreeSurface(surfaces[i]);
+    }
+    return sheet;
+}
+
+bool createAtlasTexture(SDL_Renderer* renderer, Atlas& atlas, const void* pixels, int pitch, Uint32 format) {
+    atlas.texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC, atlas.width, atlas.height);
+    if (atlas.texture && SDL_UpdateTexture(atlas.texture, nullptr, pixels, pitch) != 0) {
+        SDL_DestroyTexture(atlas.texture);
+        atlas.texture = nullptr;
+    }
+    if (!atlas.texture) {
+        destroyAtlas(atlas);
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+bool buildAtlas(SDL_Renderer* renderer, Atlas& atlas, const char* const* paths, const char* const* names, int count,
+                const bool* directional) {
+    std::vector<SDL_Surface*> images(count, nullptr);
+    for (int i = 0; i < count; i++) {
+        SDL_Surface* loaded = IMG_Load(paths[i]);
+        if (!loaded) continue;
+        images[i] = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+    }
+    SDL_Surface* sheet = packAtlas(atlas, images.data(), names, count, directional);
+    for (SDL_Surface* image : images)
+        SDL_FreeSurface(image);
+    if (!sheet) return false;
+    bool ok = createAtlasTexture(renderer, atlas, sheet->pixels, sheet->pitch, sheet->format->format);
+    SDL_FreeSurface(sheet);
+    return ok;
+}
+
+// Vùng ảnh đọc từ gói phải nằm trong tấm ảnh width x height, và mỗi bản xoay sẵn là -1
+// hoặc một vùng có thật trong bảng count vùng
+static bool validPackSprite(const PackSprite& sprite, int count, int width, int height) {
+    if (sprite.x < 0 || sprite.y < 0 || sprite.w < 0 || sprite.h < 0) return false;
+    if ((int64_t)sprite.x + sprite.w > width || (int64_t)sprite.y + sprite.h > height) return false;
+    for (int k = 0; k < 4; k++) {
+        if (sprite.turned[k] < -1 || sprite.turned[k] >= count) return false;
+    }
+    return true;
+}
+
+const PackEntry* readAtlas(Atlas& atlas, const AssetPack& pack) {
+    destroyAtlas(atlas);
+    const PackEntry* pixels = findEntry(pack, ATLAS_PACK_NAME, PACK_IMAGE);
+    const PackEntry* table = findEntry(pack, ATLAS_PACK_NAME, PACK_SPRITES);
+    if (!pixels || !table) return nullptr;
+    // Gói hỏng không được làm createAtlasTexture đọc quá vùng ánh xạ: điểm ảnh RGBA32, mỗi
+    // hàng ít nhất width * 4 byte, và tích pitch * height tính bằng 64 bit để không tràn
+    if (pixels->width <= 0 || pixels->height <= 0 || pixels->width > ATLAS_MAX_SIZE ||
+        pixels->height > ATLAS_MAX_SIZE || SDL_BYTESPERPIXEL(pixels->format) != 4 ||
+        pixels->pitch < pixels->width * 4 || (uint64_t)pixels->size < (uint64_t)pixels->pitch * pixels->height)
+        return nullptr;
+
+    const PackSprite* sprites = (const PackSprite*)entryData(pack, *table);
+    int count = table->size / sizeof(PackSprite);
+    for (int i = 0; i < count; i++) {
+        if (!validPackSprite(sprites[i], count, pixels->width, pixels->height)) {
+            atlas.sprites.clear();
+            return nullptr;
+        }
+        AtlasSprite sprite;
+        sprite.name = std::string(sprites[i].name, strnlen(sprites[i].name, sizeof(sprites[i].name)));
+        sprite.rect = {sprites[i].x, sprites[i].y, sprites[i].w, sprites[i].h};
+        for (int k = 0; k < 4; k++)
+            sprite.turned[k] = sprites[i].turned[k];
+        atlas.sprites.push_back(sprite);
+    }
+    atlas.width = pixels->width;
+    atlas.height = pixels->height;
+    computeUV(atlas);
+    return pixels;
+}
+
+bool loadAtlas(SDL_Renderer* renderer, Atlas& atlas, const AssetPack& pack) {
+    const PackEntry* pixels = readAtlas(atlas, pack);
+    // Điểm ảnh đã đúng định dạng texture nên được chép thẳng từ vùng nhớ ánh xạ
+    return pixels && createAtlasTexture(renderer, atlas, entryData(pack, *pixels), pixels->pitch, pixels->format);
+}
+
+void savePackAtlas(PackBuilder& builder, const Atlas& atlas, SDL_Surface* sheet) {
+    addPackEntry(builder, ATLAS_PACK_NAME, PACK_IMAGE, sheet->pixels, (size_t)sheet->pitch * sheet->h,
+                 sheet->format->format, sheet->w, sheet->h, sheet->pitch);
+    std::vector<PackSprite> sprites(atlas.sprites.size());
+    for (int i = 0; i < (int)sprites.size(); i++) {
+        const AtlasSprite& sprite = atlas.sprites[i];
+        memset(&sprites[i], 0, sizeof(PackSprite));
+        strncpy(sprites[i].name, sprite.name.c_str(), sizeof(sprites[i].name) - 1);
+        sprites[i].x = sprite.rect.x;
+        sprites[i].y = sprite.rect.y;
+        sprites[i].w = sprite.rect.w;
+        sprites[i].h = sprite.rect.h;
+        for (int k = 0; k < 4; k++)
+            sprites[i].turned[k] = sprite.turned[k];
+    }
+    addPackEntry(builder, ATLAS_PACK_NAME, PACK_SPRITES, sprites.data(), sprites.size() * sizeof(PackSprite), 0, 0, 0, 0);
+}
+
+int findSprite(const Atlas& atlas, const char* name) {
+    for (int i = 0; i < (int)atlas.sprites.size(); i++) {
+        if (strcmp(atlas.sprites[i].name.c_str(), name) == 0) return i;
+    }
+    return -1;
+}
+
+int turnedSprite(const Atlas& atlas, int sprite, double angle) {
+    if (sprite < 0) return -1;
+    double quarter = angle / 90.0;
+    if (quarter != std::floor(quarter)) return -1;
+    int turns = ((int)quarter % 4 + 4) % 4;
+    return atlas.sprites[sprite].turned[turns];
+}
+
+void destroyAtlas(Atlas& atlas) {
+    if (atlas.texture) SDL_DestroyTexture(atlas.texture);
+    atlas.texture = nullptr;
+    atlas.width = atlas.height = 0;
+    atlas.sprites.clear();
+}
@@ -0,0 +1,60 @@
+#pragma once
+// Tập ảnh (atlas): lúc khởi động đọc mọi ảnh của game và xếp chúng vào một
+// texture duy nhất, mỗi ảnh là một vùng con tra theo tên. Cả khung hình vẽ từ
+// cùng một texture nên có thể gom thành một lô (velo.h) và một lệnh vẽ.
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "goi.h"
+
+struct AtlasSprite {
+    std::string name;
+    SDL_Rect rect;          // Vùng trong texture (pixel)
+    float u0, v0, u1, v1;   // Cùng vùng đó theo tọa độ texture [0, 1]
+    int turned[4];          // Vùng của cùng ảnh xoay sẵn 0/90/180/270 độ theo chiều kim đồng hồ, -1 nếu không có
+};
+
+struct Atlas {
+    SDL_Texture* texture = nullptr;
+    int width = 0, height = 0;
+    std::vector<AtlasSprite> sprites;
+};
+
+// Tên của vùng trắng đặc 4x4 luôn có trong tập ảnh, dùng để vẽ hình chữ nhật tô màu
+extern const char* const ATLAS_WHITE;
+// Tên các mục của tập ảnh trong gói tài nguyên (goi.h)
+extern const char* const ATLAS_PACK_NAME;
+
+// Đọc count ảnh paths[i] và xếp vào một texture, vùng của ảnh i mang tên names[i].
+// Nếu directional[i] thì xếp thêm 3 bản xoay sẵn của ảnh, tên names[i] + "@90", "@180",
+// "@270", để vật chỉ quay theo 4 hướng được vẽ thẳng không cần xoay lúc vẽ.
+// Ảnh không đọc được bị bỏ qua (findSprite trả về -1). Trả về false nếu không tạo được texture.
+bool buildAtlas(SDL_Renderer* renderer, Atlas& atlas, const char* const* paths, const char* const* names, int count,
+                const bool* directional = nullptr);
+
+// Đọc tập ảnh đã xếp sẵn trong gói tài nguyên: texture được tạo thẳng từ điểm ảnh trong
+// vùng nhớ ánh xạ, không giải mã PNG. false nếu gói không có tập ảnh.
+bool loadAtlas(SDL_Renderer* renderer, Atlas& atlas, const AssetPack& pack);
+// Phần không cần renderer của loadAtlas (chạy được ở luồng nền): đọc bảng vùng vào atlas
+// và trả về mục điểm ảnh để tạo texture sau, nullptr nếu gói không có tập ảnh hoặc tập ảnh
+// sai (vùng ảnh ra ngoài tấm ảnh, bản xoay trỏ sai, pitch hay kích thước mục không khớp)
+const PackEntry* readAtlas(Atlas& atlas, const AssetPack& pack);
+
+// Phần không cần renderer của buildAtlas, cho công cụ donggoi: xếp count ảnh RGBA32
+// images[i] (nullptr thì bỏ qua) vào atlas và trả về tấm ảnh chung (người gọi giải phóng),
+// nullptr nếu không xếp được. atlas.texture vẫn là nullptr.
+SDL_Surface* packAtlas(Atlas& atlas, SDL_Surface* const* images, const char* const* names, int count,
+                       const bool* directional = nullptr);
+// Tạo texture của atlas từ điểm ảnh của tấm ảnh chung có định dạng format
+bool createAtlasTexture(SDL_Renderer* renderer, Atlas& atlas, const void* pixels, int pitch, Uint32 format);
+// Thêm tấm ảnh sheet và bảng vùng của atlas vào gói đang tạo
+void savePackAtlas(PackBuilder& builder, const Atlas& atlas, SDL_Surface* sheet);
+
+// Chỉ số vùng có tên name, -1 nếu không có
+int findSprite(const Atlas& atlas, const char* name);
+
+// Vùng xoay sẵn của sprite theo góc angle (độ); -1 nếu angle không phải bội của 90
+// hoặc ảnh không có bản xoay đó
+int turnedSprite(const Atlas& atlas, int sprite, double angle);
+
+void destroyAtlas(Atlas& atlas);
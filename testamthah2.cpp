@@ -4,6 +4,15 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "goi.h"          // Gói tài nguyên tạo bởi donggoi (âm thanh PCM dùng thẳng từ mmap)
+#include "amthanh.h"      // Gộp sự kiện âm thanh mỗi tick và giới hạn số kênh phát
+#include "luongam.h"      // Nhạc nền phát theo luồng từ file WAV ánh xạ vào bộ nhớ
+
+// Biên dịch: g++ testamthah2.cpp goi.cpp amthanh.cpp luongam.cpp -pthread -lSDL2main -lSDL2 -lSDL2_image -lSDL2_mixer
 
 // Kích thước cửa sổ
 const int SCREEN_WIDTH = 720;
@@ -19,8 +28,10 @@ const int OBSTACLE_COLS = 8;
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
 SDL_Texture* obstacleTexture = nullptr;
-SDL_Texture* tankTexture = nullptr;    // xe tăng 1
-SDL_Texture* tank2Texture = nullptr;   // xe tăng 2
+// Xe tăng chỉ quay 0/90/180/270 độ nên mỗi xe có sẵn 4 texture đã xoay,
+// chỉ số là số lần xoay 90 độ theo chiều kim đồng hồ; vẽ bằng SDL_RenderCopy
+SDL_Texture* tankTextures[4] = {nullptr, nullptr, nullptr, nullptr};  // xe tăng 1
+SDL_Texture* tank2Textures[4] = {nullptr, nullptr, nullptr, nullptr}; // xe tăng 2
 SDL_Texture* bulletTexture = nullptr;  // texture đạn (dan.png)
 
 // Danh sách chướng ngại vật
@@ -50,7 +61,14 @@ std::vector<Bullet> bullets;
 
 // Biến âm thanh toàn cục
 Mix_Chunk* fireSound = nullptr;     // âm thanh khi bắn đạn
-Mix_Music* backgroundMusic = nullptr; // (nếu cần nhạc nền, không bắt buộc)
+AudioStream backgroundMusic;        // nhạc nền (không bắt buộc: không có file thì thôi)
+
+// Mọi âm thanh trong game phát qua đây: postSound khi có sự kiện, flushSounds mỗi tick
+SoundMixer sounds;
+int fireSoundId = -1;
+
+// Gói tài nguyên phải mở tới khi giải phóng âm thanh vì chunk trỏ thẳng vào vùng nhớ của gói
+AssetPack assetPack;
 
 bool init() {
     // Khởi tạo video và âm thanh
@@ -58,10 +76,7 @@ bool init() {
         std::cout << "SDL không khởi tạo được! SDL_Error: " << SDL_GetError() << std::endl;
         return false;
     }
-    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
-        std::cout << "SDL_image không khởi tạo được! IMG_Error: " << IMG_GetError() << std::endl;
-        return false;
-    }
+    // SDL_image được khởi tạo ở luồng nạp tài nguyên (loadAssets)
     // Khởi tạo SDL_mixer với tần số 44100 Hz, định dạng mặc định, 2 kênh, và chunk size 2048
     if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
         std::cout << "SDL_mixer không khởi tạo được! Mix_Error: " << Mix_GetError() << std::endl;
@@ -69,6 +84,7 @@ bool init() {
     }
     // Đặt âm lượng cho tất cả kênh (MIX_MAX_VOLUME = 128)
     Mix_Volume(-1, MIX_MAX_VOLUME);
+    initSoundMixer(sounds);
 
     window = SDL_CreateWindow("Battle City 2 Người Chơi", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
                               SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
@@ -84,21 +100,159 @@ bool init() {
     return true;
 }
 
-SDL_Texture* loadTexture(const char* path) {
-    SDL_Texture* newTexture = nullptr;
+// Đọc ảnh path thành surface (chạy được ở luồng nền, không cần renderer)
+SDL_Surface* loadSurface(const char* path) {
     SDL_Surface* loadedSurface = IMG_Load(path);
     if (!loadedSurface) {
         std::cout << "Không tải được ảnh " << path << "! IMG_Error: " << IMG_GetError() << std::endl;
-        return nullptr;
     }
-    newTexture = SDL_CreateTextureFromSurface(renderer, loadedSurface);
+    return loadedSurface;
+}
+
+// Tạo texture từ surface đã nạp (ở luồng vẽ) rồi giải phóng surface
+SDL_Texture* createTexture(SDL_Surface* surface) {
+    if (!surface) return nullptr;
+    SDL_Texture* newTexture = SDL_CreateTextureFromSurface(renderer, surface);
     if (!newTexture) {
-        std::cout << "Không tạo được texture từ " << path << "! SDL_Error: " << SDL_GetError() << std::endl;
+        std::cout << "Không tạo được texture! SDL_Error: " << SDL_GetError() << std::endl;
     }
-    SDL_FreeSurface(loadedSurface);
+    SDL_FreeSurface(surface);
     return newTexture;
 }
 
+// Đọc ảnh path thành 4 surface xoay sẵn 0/90/180/270 độ theo chiều kim đồng hồ (như
+// SDL_RenderCopyEx). Chỉ chép điểm ảnh một lần lúc tải, không phải xoay mỗi khung hình.
+void loadTurnedSurfaces(const char* path, SDL_Surface* surfaces[4]) {
+    SDL_Surface* loadedSurface = loadSurface(path);
+    if (!loadedSurface) return;
+    SDL_Surface* source = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loadedSurface);
+    if (!source) return;
+    int w = source->w, h = source->h;
+    for (int turns = 0; turns < 4; turns++) {
+        bool swap = turns % 2 == 1;
+        SDL_Surface* rotated = SDL_CreateRGBSurfaceWithFormat(0, swap ? h : w, swap ? w : h, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!rotated) continue;
+        for (int y = 0; y < h; y++) {
+            const Uint32* row = (const Uint32*)((const Uint8*)source->pixels + y * source->pitch);
+            for (int x = 0; x < w; x++) {
+                // Điểm (x, y) của ảnh gốc rơi vào (dx, dy) của ảnh xoay
+                int dx = x, dy = y;
+                if (turns == 1)      { dx = h - 1 - y; dy = x; }
+                else if (turns == 2) { dx = w - 1 - x; dy = h - 1 - y; }
+                else if (turns == 3) { dx = y;         dy = w - 1 - x; }
+                ((Uint32*)((Uint8*)rotated->pixels + dy * rotated->pitch))[dx] = row[x];
+            }
+        }
+        surfaces[turns] = rotated;
+    }
+    SDL_FreeSurface(source);
+}
+
+// Chỉ số texture xoay sẵn cho góc angle (0/90/180/270)
+int turnIndex(double angle) {
+    return ((int)(angle / 90.0) % 4 + 4) % 4;
+}
+
+// Nạp tài nguyên ở luồng nền, song song với việc tạo cửa sổ, renderer và mở âm thanh ở
+// luồng chính. Luồng nền chỉ giải mã ra surface và PCM; texture và Mix_Chunk được tạo ở
+// luồng chính khi cả hai bên xong. Các biến loaded* chỉ được đọc sau khi assetsReady là true.
+SDL_Surface* loadedObstacle = nullptr;
+SDL_Surface* loadedTanks[4] = {nullptr, nullptr, nullptr, nullptr};
+SDL_Surface* loadedTanks2[4] = {nullptr, nullptr, nullptr, nullptr};
+SDL_Surface* loadedBullet = nullptr;
+std::vector<Uint8> fireSamples; // PCM của pim.wav khi không có gói; fireSound trỏ vào đây
+std::atomic<int> assetsLoaded(0); // Tiến độ cho màn hình chờ, trên ASSET_COUNT
+std::atomic<bool> assetsReady(false);
+const int ASSET_COUNT = 5;
+double decodeMs = 0;
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Đọc pim.wav và đổi sang PCM 44100 Hz, 16 bit, 2 kênh như Mix_OpenAudio trong init()
+void loadFireSamples() {
+    SDL_AudioSpec spec;
+    Uint8* buffer = nullptr;
+    Uint32 length = 0;
+    if (!SDL_LoadWAV("pim.wav", &spec, &buffer, &length)) return;
+    SDL_AudioCVT cvt;
+    int built = SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                                  AUDIO_S16SYS, PACK_AUDIO_CHANNELS, PACK_AUDIO_FREQUENCY);
+    if (built >= 0) {
+        fireSamples.resize((size_t)length * cvt.len_mult);
+        memcpy(fireSamples.data(), buffer, length);
+        cvt.buf = fireSamples.data();
+        cvt.len = length;
+        cvt.len_cvt = length;
+        if (built == 0 || SDL_ConvertAudio(&cvt) == 0) fireSamples.resize(cvt.len_cvt);
+        else fireSamples.clear();
+    }
+    SDL_FreeWAV(buffer);
+}
+
+void loadAssets() {
+    auto start = std::chrono::steady_clock::now();
+    if (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) {
+        loadedObstacle = loadSurface("obstacle.png");
+        assetsLoaded++;
+        loadTurnedSurfaces("tank.png", loadedTanks);   // xe tăng 1
+        assetsLoaded++;
+        loadTurnedSurfaces("tank2.png", loadedTanks2); // xe tăng 2
+        assetsLoaded++;
+        loadedBullet = loadSurface("dan.png");         // ảnh đạn, nếu không tải được sẽ vẽ đạn màu đen
+        assetsLoaded++;
+    } else {
+        std::cout << "SDL_image không khởi tạo được! IMG_Error: " << IMG_GetError() << std::endl;
+    }
+    // Âm thanh bắn đạn: lấy từ tainguyen.pak nếu có (đọc trước các trang của gói), không thì giải mã pim.wav
+    if (openPack(assetPack, "tainguyen.pak") && findEntry(assetPack, "pim", PACK_SOUND))
+        touchPack(assetPack);
+    else
+        loadFireSamples();
+    assetsLoaded++;
+    decodeMs = millisecondsSince(start);
+    assetsReady = true;
+}
+
+// Màn hình chờ khi luồng nền chưa xong lúc cửa sổ đã sẵn sàng: thanh tiến độ theo số
+// tài nguyên đã nạp. Trả về false nếu người chơi đóng cửa sổ trong lúc chờ.
+bool waitForAssets() {
+    while (!assetsReady) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) return false;
+        }
+        SDL_Rect frame = {SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 10, SCREEN_WIDTH / 2, 20};
+        SDL_Rect bar = {frame.x + 2, frame.y + 2, (frame.w - 4) * assetsLoaded / ASSET_COUNT, frame.h - 4};
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawRect(renderer, &frame);
+        SDL_RenderFillRect(renderer, &bar);
+        SDL_RenderPresent(renderer);
+        SDL_Delay(16);
+    }
+    return true;
+}
+
+// PCM có đúng định dạng SDL_mixer đang mở không (để dùng thẳng bằng Mix_QuickLoad_RAW)
+bool mixerAccepts(int frequency, int format, int channels) {
+    int openFrequency = 0, openChannels = 0;
+    Uint16 openFormat = 0;
+    return Mix_QuerySpec(&openFrequency, &openFormat, &openChannels) &&
+           openFrequency == frequency && openFormat == format && openChannels == channels;
+}
+
+// Âm thanh name trong gói tài nguyên, dùng thẳng PCM trong vùng nhớ ánh xạ (không đọc,
+// không đổi định dạng WAV). nullptr nếu gói không có hoặc định dạng khác Mix_OpenAudio.
+Mix_Chunk* loadPackSound(const char* name) {
+    const PackEntry* entry = findEntry(assetPack, name, PACK_SOUND);
+    if (!entry || !mixerAccepts(entry->width, entry->format, entry->height)) return nullptr;
+    return Mix_QuickLoad_RAW((Uint8*)entryData(assetPack, *entry), entry->size);
+}
+
 // Hàm kiểm tra va chạm giữa 2 hình chữ nhật
 bool checkCollision(const SDL_Rect& a, const SDL_Rect& b) {
     return (a.x < b.x + b.w && a.x + a.w > b.x &&
@@ -122,13 +276,8 @@ void setupObstacles() {
 
 // Hàm tạo viên đạn mới, thêm phát âm thanh khi bắn
 void shootBullet(int owner, const SDL_Rect& tank, double angle) {
-    // Phát âm thanh khi bắn đạn
-    if (fireSound) {
-        int channel = Mix_PlayChannel(-1, fireSound, 0);
-        if (channel == -1) {
-            std::cout << "Không thể phát âm thanh: " << Mix_GetError() << std::endl;
-        }
-    }
+    // Phát âm thanh khi bắn đạn (cuối tick, gộp với các phát bắn khác trong cùng tick)
+    postSound(sounds, fireSoundId);
 
     int bulletSize = CELL_SIZE / 3;
     SDL_Rect bulletRect;
@@ -281,14 +430,14 @@ void render() {
     }
 
     // Vẽ xe tăng 1
-    if (player1Alive && tankTexture) {
-        SDL_RenderCopyEx(renderer, tankTexture, nullptr, &tank1, tank1Angle, nullptr, SDL_FLIP_NONE);
+    if (player1Alive) {
+        SDL_RenderCopy(renderer, tankTextures[turnIndex(tank1Angle)], nullptr, &tank1);
     }
     // Vẽ xe tăng 2
-    if (player2Alive && tank2Texture) {
-        SDL_RenderCopyEx(renderer, tank2Texture, nullptr, &tank2, tank2Angle, nullptr, SDL_FLIP_NONE);
+    if (player2Alive) {
+        SDL_RenderCopy(renderer, tank2Textures[turnIndex(tank2Angle)], nullptr, &tank2);
     }
-    // Vẽ đạn
+    // Vẽ đạn (đạn bay theo góc bất kỳ nên vẫn xoay lúc vẽ)
     for (const auto &bullet : bullets) {
         if (bulletTexture) {
             SDL_RenderCopyEx(renderer, bulletTexture, nullptr, &bullet.rect, bullet.angle, nullptr, SDL_FLIP_NONE);
@@ -304,18 +453,27 @@ void render() {
 
 // Giải phóng các tài nguyên SDL và SDL_mixer
 void closeAll() {
+    if (sounds.events > 0) {
+        std::cout << "Âm thanh: " << sounds.events << " sự kiện, phát " << sounds.played << " lần, cướp kênh "
+                  << sounds.stolen << ", bỏ " << sounds.dropped << std::endl;
+    }
+    Mix_HaltChannel(-1);
     Mix_FreeChunk(fireSound);
     fireSound = nullptr;
-    Mix_FreeMusic(backgroundMusic);
-    backgroundMusic = nullptr;
+    if (backgroundMusic.underruns > 0)
+        std::cout << "Nhạc nền thiếu dữ liệu " << backgroundMusic.underruns << " lần" << std::endl;
+    closeAudioStream(backgroundMusic);
     Mix_CloseAudio();
+    closePack(assetPack);
 
     SDL_DestroyTexture(obstacleTexture);
     obstacleTexture = nullptr;
-    SDL_DestroyTexture(tankTexture);
-    tankTexture = nullptr;
-    SDL_DestroyTexture(tank2Texture);
-    tank2Texture = nullptr;
+    for (int turns = 0; turns < 4; turns++) {
+        SDL_DestroyTexture(tankTextures[turns]);
+        tankTextures[turns] = nullptr;
+        SDL_DestroyTexture(tank2Textures[turns]);
+        tank2Textures[turns] = nullptr;
+    }
     SDL_DestroyTexture(bulletTexture);
     bulletTexture = nullptr;
 
@@ -328,37 +486,77 @@ void closeAll() {
     SDL_Quit();
 }
 
+// Cách dùng: testamthah2 [--serial]  (--serial: nạp tài nguyên ở luồng chính sau khi tạo cửa sổ
+// như trước đây, để so thời gian tới khung hình đầu tiên với khi nạp ở luồng nền)
 int main(int argc, char* argv[]) {
-    if (!init())
-        return -1;
+    bool serial = argc > 1 && strcmp(argv[1], "--serial") == 0;
+
+    // Bắt đầu giải mã tài nguyên trước khi tạo cửa sổ (--serial: sau khi tạo cửa sổ, ở luồng
+    // chính); thời gian tới khung hình đầu tiên tính từ đây
+    auto startTime = std::chrono::steady_clock::now();
+    std::thread loader;
+    if (!serial) loader = std::thread(loadAssets);
+    bool initialized = init();
+    double initMs = millisecondsSince(startTime);
+    if (serial && initialized) loadAssets();
+    bool loaded = initialized && waitForAssets();
+    if (loader.joinable()) loader.join();
+    double waitMs = millisecondsSince(startTime) - initMs;
+    if (!loaded) {
+        // Không tạo được cửa sổ hoặc người chơi đóng cửa sổ trong lúc chờ
+        SDL_FreeSurface(loadedObstacle);
+        SDL_FreeSurface(loadedBullet);
+        for (int turns = 0; turns < 4; turns++) {
+            SDL_FreeSurface(loadedTanks[turns]);
+            SDL_FreeSurface(loadedTanks2[turns]);
+        }
+        closeAll();
+        return initialized ? 0 : -1;
+    }
 
-    // Tải texture
-    obstacleTexture = loadTexture("obstacle.png");
-    tankTexture = loadTexture("tank.png");      // xe tăng 1
-    tank2Texture = loadTexture("tank2.png");      // xe tăng 2
-    bulletTexture = loadTexture("dan.png");       // texture đạn, nếu không tải được sẽ vẽ đạn màu đen
+    // Tạo texture ở luồng vẽ từ các surface luồng nền đã giải mã
+    obstacleTexture = createTexture(loadedObstacle);
+    bool tanksLoaded = true;
+    for (int turns = 0; turns < 4; turns++) {
+        tankTextures[turns] = createTexture(loadedTanks[turns]);
+        tank2Textures[turns] = createTexture(loadedTanks2[turns]);
+        tanksLoaded = tanksLoaded && tankTextures[turns] && tank2Textures[turns];
+    }
+    bulletTexture = createTexture(loadedBullet);
 
-    if (!obstacleTexture || !tankTexture || !tank2Texture) {
+    if (!obstacleTexture || !tanksLoaded) {
         std::cout << "Không tải được một hoặc nhiều texture!" << std::endl;
         closeAll();
         return -1;
     }
 
-    // Load âm thanh từ file pim.wav (âm thanh bắn đạn)
-    fireSound = Mix_LoadWAV("pim.wav");
+    // Âm thanh bắn đạn: PCM trong tainguyen.pak, hoặc PCM luồng nền đã giải mã từ pim.wav;
+    // chỉ khi SDL_mixer mở ra định dạng khác mới phải để Mix_LoadWAV đọc lại file
+    fireSound = loadPackSound("pim");
+    if (!fireSound && !fireSamples.empty() && mixerAccepts(PACK_AUDIO_FREQUENCY, AUDIO_S16SYS, PACK_AUDIO_CHANNELS))
+        fireSound = Mix_QuickLoad_RAW(fireSamples.data(), fireSamples.size());
+    if (!fireSound) fireSound = Mix_LoadWAV("pim.wav");
     if (!fireSound) {
         std::cout << "Không load được âm thanh bắn đạn! Mix_Error: " << Mix_GetError() << std::endl;
     } else {
-        std::cout << "Load âm thanh pim.wav thành công!" << std::endl;
+        std::cout << "Load âm thanh bắn đạn thành công!" << std::endl;
+    }
+    // Ưu tiên thấp, tối đa 4 kênh: bắn liên tục thì thay tiếng cũ nhất thay vì chồng thêm
+    fireSoundId = addSound(sounds, fireSound, 1, 4, MIX_MAX_VOLUME / 2);
+
+    // Nhạc nền: chỉ ánh xạ file, luồng nạp của luongam đổi dần vài KB kế tiếp nên không phải
+    // chờ giải mã cả bài và bộ nhớ dùng không tăng theo độ dài bài
+    if (openAudioStream(backgroundMusic, "nhacnen.wav", true)) {
+        backgroundMusic.volume = MIX_MAX_VOLUME / 3;
+        playAudioStream(backgroundMusic);
+    } else {
+        std::cout << "Không phát nhạc nền: " << SDL_GetError() << std::endl;
     }
-
-    // Nếu bạn muốn chạy nhạc nền, uncomment và load file nhạc nền (ví dụ background.mp3)
-    // backgroundMusic = Mix_LoadMUS("background.mp3");
-    // if (backgroundMusic) Mix_PlayMusic(backgroundMusic, -1);
 
     setupObstacles();
 
     bool quit = false;
+    bool firstFrame = true;
     SDL_Event e;
     while (!quit) {
         while (SDL_PollEvent(&e)) {
@@ -367,11 +565,20 @@ int main(int argc, char* argv[]) {
             handleInput(e);
         }
         updateBullets();
+        flushSounds(sounds);
         render();
+        if (firstFrame) {
+            // Đo thật cả hai cách: chạy thường (luồng nền) và chạy với --serial rồi so hai số
+            double firstFrameMs = millisecondsSince(startTime);
+            std::cout << "Khung hình đầu tiên sau " << firstFrameMs << " ms, "
+                      << (serial ? "nạp tuần tự" : "nạp ở luồng nền") << " (tạo cửa sổ " << initMs
+                      << " ms, nạp " << decodeMs << " ms, chờ sau khi tạo cửa sổ " << waitMs << " ms)" << std::endl;
+            firstFrame = false;
+        }
 
         // Nếu một trong hai xe đã bị tiêu diệt, kết thúc game sau 2 giây
         if (!player1Alive || !player2Alive) {
-            SDL_Delay(2000);
+            SDL_Delay(2000); // Nhạc nền vẫn phát nhờ luồng nạp
             quit = true;
         }
         SDL_Delay(16); // khoảng 60 FPS
@@ -0,0 +1,139 @@
+#include "vacham.h"
+#include <atomic>
+#include <cstring>
+
+// Nhân SIMD cần __attribute__((target)) và __builtin_cpu_supports của GCC/Clang; trình
+// biên dịch khác (MSVC) chỉ có nhân vô hướng
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define VACHAM_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*OneToManyFunc)(Rect, const int*, const int*, const int*, const int*, int, unsigned int*);
+
+// Phần cuối (hoặc toàn bộ với nhân vô hướng) xử lý từng hộp một
+static void oneToManyScalar(Rect a, const int* x, const int* y, const int* w, const int* h,
+                            int start, int count, unsigned int* mask) {
+    for (int i = start; i < count; i++) {
+        if (a.x < x[i] + w[i] && a.x + a.w > x[i] &&
+            a.y < y[i] + h[i] && a.y + a.h > y[i])
+            mask[i >> 5] |= 1u << (i & 31);
+    }
+}
+
+static void oneToManyScalarAll(Rect a, const int* x, const int* y, const int* w, const int* h,
+                               int count, unsigned int* mask) {
+    oneToManyScalar(a, x, y, w, h, 0, count, mask);
+}
+
+#ifdef VACHAM_X86
+__attribute__((target("sse2"))) // x86 32 bit không mặc định có SSE2
+static void oneToManySSE2(Rect a, const int* x, const int* y, const int* w, const int* h,
+                          int count, unsigned int* mask) {
+    const __m128i ax = _mm_set1_epi32(a.x);
+    const __m128i ay = _mm_set1_epi32(a.y);
+    const __m128i axw = _mm_set1_epi32(a.x + a.w);
+    const __m128i ayh = _mm_set1_epi32(a.y + a.h);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i bx = _mm_loadu_si128((const __m128i*)(x + i));
+        __m128i by = _mm_loadu_si128((const __m128i*)(y + i));
+        __m128i bxw = _mm_add_epi32(bx, _mm_loadu_si128((const __m128i*)(w + i)));
+        __m128i byh = _mm_add_epi32(by, _mm_loadu_si128((const __m128i*)(h + i)));
+        // a.x < b.x + b.w && a.x + a.w > b.x && a.y < b.y + b.h && a.y + a.h > b.y
+        __m128i hit = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(bxw, ax), _mm_cmpgt_epi32(axw, bx)),
+                                    _mm_and_si128(_mm_cmpgt_epi32(byh, ay), _mm_cmpgt_epi32(ayh, by)));
+        unsigned int bits = _mm_movemask_ps(_mm_castsi128_ps(hit));
+        mask[i >> 5] |= bits << (i & 31);
+    }
+    oneToManyScalar(a, x, y, w, h, i, count, mask);
+}
+
+__attribute__((target("avx2")))
+static void oneToManyAVX2(Rect a, const int* x, const int* y, const int* w, const int* h,
+                          int count, unsigned int* mask) {
+    const __m256i ax = _mm256_set1_epi32(a.x);
+    const __m256i ay = _mm256_set1_epi32(a.y);
+    const __m256i axw = _mm256_set1_epi32(a.x + a.w);
+    const __m256i ayh = _mm256_set1_epi32(a.y + a.h);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i bx = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i by = _mm256_loadu_si256((const __m256i*)(y + i));
+        __m256i bxw = _mm256_add_epi32(bx, _mm256_loadu_si256((const __m256i*)(w + i)));
+        __m256i byh = _mm256_add_epi32(by, _mm256_loadu_si256((const __m256i*)(h + i)));
+        __m256i hit = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(bxw, ax), _mm256_cmpgt_epi32(axw, bx)),
+                                       _mm256_and_si256(_mm256_cmpgt_epi32(byh, ay), _mm256_cmpgt_epi32(ayh, by)));
+        unsigned int bits = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        mask[i >> 5] |= bits << (i & 31);
+    }
+    oneToManyScalar(a, x, y, w, h, i, count, mask);
+}
+#endif
+
+static bool kernelSupported(CollisionKernel kernel) {
+    switch (kernel) {
+        case KERNEL_SCALAR: return true;
+#ifdef VACHAM_X86
+        case KERNEL_SSE2: return __builtin_cpu_supports("sse2");
+        case KERNEL_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+// Nhân đang dùng, -1 khi chưa chọn. Lõi mô phỏng chạy trên nhiều luồng (chaynhieutran) nên
+// lưu bằng atomic; hàm của nhân suy ra từ số nhân mỗi lần gọi để hai giá trị không lệch nhau.
+static std::atomic<int> currentKernel{-1};
+
+static OneToManyFunc kernelFunc(int kernel) {
+    switch (kernel) {
+#ifdef VACHAM_X86
+        case KERNEL_SSE2: return oneToManySSE2;
+        case KERNEL_AVX2: return oneToManyAVX2;
+#endif
+        default: return oneToManyScalarAll;
+    }
+}
+
+bool setCollisionKernel(CollisionKernel kernel) {
+    if (!kernelSupported(kernel)) return false;
+    currentKernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+CollisionKernel collisionKernel() {
+    int kernel = currentKernel.load(std::memory_order_relaxed);
+    if (kernel < 0) {
+        // Nhiều luồng cùng gọi lần đầu thì đều chọn ra cùng một nhân; chỉ ghi khi chưa
+        // ai chọn, để không đè nhân đã ép bằng setCollisionKernel
+        int best = kernelSupported(KERNEL_AVX2) ? KERNEL_AVX2 : kernelSupported(KERNEL_SSE2) ? KERNEL_SSE2 : KERNEL_SCALAR;
+        if (currentKernel.compare_exchange_strong(kernel, best, std::memory_order_relaxed)) kernel = best;
+    }
+    return (CollisionKernel)kernel;
+}
+
+const char* collisionKernelName(CollisionKernel kernel) {
+    switch (kernel) {
+        case KERNEL_SSE2: return "sse2";
+        case KERNEL_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void collideOneToMany(Rect a, const int* x, const int* y, const int* w, const int* h,
+                      int count, unsigned int* mask) {
+    OneToManyFunc func = kernelFunc(collisionKernel());
+    memset(mask, 0, maskWords(count) * sizeof(unsigned int));
+    func(a, x, y, w, h, count, mask);
+}
+
+void collideManyToMany(const int* ax, const int* ay, const int* aw, const int* ah, int countA,
+                       const int* bx, const int* by, const int* bw, const int* bh, int countB,
+                       unsigned int* mask) {
+    int words = maskWords(countB);
+    for (int i = 0; i < countA; i++) {
+        Rect a = {ax[i], ay[i], aw[i], ah[i]};
+        collideOneToMany(a, bx, by, bw, bh, countB, mask + (size_t)i * words);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+// Kiểm tra va chạm AABB theo lô trên mảng tọa độ SoA (x[], y[], w[], h[]),
+// ví dụ các mảng của BulletPool. Kết quả là mặt nạ bit: bit i của
+// mask[i / 32] bằng 1 nếu hộp thứ i chạm hộp cần xét (cùng quy tắc với checkCollision).
+// Dùng AVX2 (8 hộp/lệnh) hoặc SSE2 (4 hộp/lệnh) nếu CPU hỗ trợ, không thì chạy vô hướng.
+// Nhân SIMD chỉ có khi biên dịch bằng GCC/Clang cho x86; MSVC và CPU khác dùng nhân vô hướng.
+#include "mophong.h"
+
+enum CollisionKernel { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+
+// Số từ 32 bit cần cho mặt nạ của count hộp
+inline int maskWords(int count) {
+    return (count + 31) / 32;
+}
+
+// Một hộp a với count hộp; mask phải có maskWords(count) phần tử
+void collideOneToMany(Rect a, const int* x, const int* y, const int* w, const int* h,
+                      int count, unsigned int* mask);
+
+// countA hộp với countB hộp; hàng i của mask (maskWords(countB) từ) là kết quả của hộp a thứ i
+void collideManyToMany(const int* ax, const int* ay, const int* aw, const int* ah, int countA,
+                       const int* bx, const int* by, const int* bw, const int* bh, int countB,
+                       unsigned int* mask);
+
+// Nhân đang dùng; mặc định chọn nhân tốt nhất CPU hỗ trợ ở lần gọi đầu tiên
+CollisionKernel collisionKernel();
+// Ép dùng một nhân (để so sánh); trả về false nếu CPU không hỗ trợ
+bool setCollisionKernel(CollisionKernel kernel);
+const char* collisionKernelName(CollisionKernel kernel);
@@ -0,0 +1,57 @@
+#include "velo.h"
+#include <cmath>
+
+const double PI = 3.14159265358979323846;
+
+void beginBatch(SpriteBatch& batch, SDL_Texture* texture) {
+    batch.texture = texture;
+    batch.vertices.clear();
+    batch.indices.clear();
+}
+
+void addSprite(SpriteBatch& batch, const SDL_Rect& dst, double angle, SDL_Color color) {
+    addSpriteUV(batch, dst, angle, color, 0.0f, 0.0f, 1.0f, 1.0f);
+}
+
+void addSpriteUV(SpriteBatch& batch, const SDL_Rect& dst, double angle, SDL_Color color,
+                 float u0, float v0, float u1, float v1) {
+    // Bốn góc (trên trái, trên phải, dưới phải, dưới trái) tính từ tâm hình
+    float halfW = dst.w * 0.5f;
+    float halfH = dst.h * 0.5f;
+    float centerX = dst.x + halfW;
+    float centerY = dst.y + halfH;
+    const float cornerX[4] = {-halfW, halfW, halfW, -halfW};
+    const float cornerY[4] = {-halfH, -halfH, halfH, halfH};
+    const float texX[4] = {u0, u1, u1, u0};
+    const float texY[4] = {v0, v0, v1, v1};
+
+    // Trục y hướng xuống nên góc dương là quay theo chiều kim đồng hồ, giống SDL_RenderCopyEx
+    float c = 1.0f, s = 0.0f;
+    if (angle != 0.0) {
+        double radians = angle * PI / 180.0;
+        c = (float)cos(radians);
+        s = (float)sin(radians);
+    }
+
+    int first = batch.vertices.size();
+    for (int i = 0; i < 4; i++) {
+        SDL_Vertex vertex;
+        vertex.position.x = centerX + cornerX[i] * c - cornerY[i] * s;
+        vertex.position.y = centerY + cornerX[i] * s + cornerY[i] * c;
+        vertex.color = color;
+        vertex.tex_coord.x = texX[i];
+        vertex.tex_coord.y = texY[i];
+        batch.vertices.push_back(vertex);
+    }
+    // Hai tam giác cho một hình chữ nhật
+    const int quad[6] = {0, 1, 2, 0, 2, 3};
+    for (int i = 0; i < 6; i++)
+        batch.indices.push_back(first + quad[i]);
+}
+
+int flushBatch(SDL_Renderer* renderer, SpriteBatch& batch) {
+    if (batch.indices.empty()) return 0;
+    SDL_RenderGeometry(renderer, batch.texture, batch.vertices.data(), batch.vertices.size(),
+                       batch.indices.data(), batch.indices.size());
+    return 1;
+}
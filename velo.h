@@ -0,0 +1,27 @@
+#pragma once
+// Vẽ theo lô: gom mọi hình dùng chung một texture trong một lớp vẽ vào một bộ
+// đỉnh, rồi gửi cả lô bằng một lệnh SDL_RenderGeometry (cần SDL 2.0.18 trở lên)
+// thay cho mỗi hình một lệnh SDL_RenderCopy/SDL_RenderCopyEx. Số lệnh vẽ mỗi
+// khung hình chỉ còn bằng số lô, không tăng theo số xe tăng, chướng ngại vật, đạn.
+// Thứ tự giữa các lô là thứ tự gọi flushBatch.
+#include <SDL.h>
+#include <vector>
+
+struct SpriteBatch {
+    SDL_Texture* texture; // nullptr: hình chữ nhật tô màu (thay cho SDL_RenderFillRect)
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+// Bắt đầu lô mới cho texture; giữ lại bộ nhớ của khung hình trước
+void beginBatch(SpriteBatch& batch, SDL_Texture* texture);
+
+// Thêm một hình phủ cả texture vào dst, xoay angle độ quanh tâm theo chiều kim đồng
+// hồ như SDL_RenderCopyEx, nhân màu color (như SDL_SetTextureColorMod)
+void addSprite(SpriteBatch& batch, const SDL_Rect& dst, double angle, SDL_Color color);
+// Như addSprite nhưng chỉ lấy vùng [u0, u1] x [v0, v1] của texture (ví dụ một ảnh trong tập ảnh)
+void addSpriteUV(SpriteBatch& batch, const SDL_Rect& dst, double angle, SDL_Color color,
+                 float u0, float v0, float u1, float v1);
+
+// Gửi cả lô bằng một lệnh; trả về số lệnh vẽ đã gửi (0 nếu lô rỗng)
+int flushBatch(SDL_Renderer* renderer, SpriteBatch& batch);
@@ -0,0 +1,71 @@
+#include "mophong.h"
+
+void clearEnemies(EnemyStore& store) {
+    store.count = 0;
+    store.x.clear();
+    store.y.clear();
+    store.angle.clear();
+    store.nextMove.clear();
+    store.nextShoot.clear();
+    store.slot.clear();
+    store.index.clear();
+    store.generation.clear();
+    store.freeSlots.clear();
+}
+
+EnemyHandle addEnemyEntity(EnemyStore& store, int x, int y, double angle) {
+    int slot;
+    if (!store.freeSlots.empty()) {
+        slot = store.freeSlots.back();
+        store.freeSlots.pop_back();
+    } else {
+        slot = store.index.size();
+        store.index.push_back(-1);
+        store.generation.push_back(0);
+    }
+    int i = store.count++;
+    store.x.push_back(x);
+    store.y.push_back(y);
+    store.angle.push_back(angle);
+    store.nextMove.push_back(0);
+    store.nextShoot.push_back(0);
+    store.slot.push_back(slot);
+    store.index[slot] = i;
+    EnemyHandle handle = {slot, store.generation[slot]};
+    return handle;
+}
+
+void removeEnemyAt(EnemyStore& store, int i) {
+    int slot = store.slot[i];
+    store.index[slot] = -1;
+    store.generation[slot]++; // Handle cũ của ô này hết hiệu lực
+    store.freeSlots.push_back(slot);
+
+    int last = --store.count;
+    if (i != last) {
+        store.x[i] = store.x[last];
+        store.y[i] = store.y[last];
+        store.angle[i] = store.angle[last];
+        store.nextMove[i] = store.nextMove[last];
+        store.nextShoot[i] = store.nextShoot[last];
+        store.slot[i] = store.slot[last];
+        store.index[store.slot[i]] = i;
+    }
+    store.x.pop_back();
+    store.y.pop_back();
+    store.angle.pop_back();
+    store.nextMove.pop_back();
+    store.nextShoot.pop_back();
+    store.slot.pop_back();
+}
+
+int findEnemy(const EnemyStore& store, EnemyHandle handle) {
+    if (handle.slot < 0 || handle.slot >= (int)store.index.size()) return -1;
+    if (store.generation[handle.slot] != handle.generation) return -1;
+    return store.index[handle.slot];
+}
+
+Rect enemyRect(const EnemyStore& store, int i) {
+    Rect rect = {store.x[i], store.y[i], TANK_SIZE, TANK_SIZE};
+    return rect;
+}